@@ -17,8 +17,12 @@
 #import "UIBezierPath+DKOSX.h"
 #import "UIBezierPath+Trimming.h"
 #import "UIBezierPath+Ahmed.h"
+#import "UIBezierPath+Simplification.h"
+#import "UIBezierPath+Scanlines.h"
 #import "DKUIBezierPathClippedSegment.h"
 #import "DKUIBezierPathClippingResult.h"
+#import "DKUIBezierPathClippingOptions.h"
+#import "DKUIBezierPathClippingOperation.h"
 #import "DKUIBezierPathIntersectionPoint.h"
 #import "DKUIBezierUnmatchedPathIntersectionPoint.h"
 #import "DKUIBezierPathShape.h"
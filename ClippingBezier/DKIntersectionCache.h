@@ -0,0 +1,77 @@
+//
+//  DKIntersectionCache.h
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#ifndef DKIntersectionCache_h
+#define DKIntersectionCache_h
+
+#import <UIKit/UIKit.h>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * a bounded least recently used cache of the intersections
+ * found between two cubic beziers. editing tends to slice
+ * the same elements over and over, and the pieces left over
+ * from a slice are mostly exact copies of the old elements,
+ * so their intersections don't need to be found again.
+ *
+ * entries are keyed by the exact bits of both curves' control
+ * points and the clipping precision, so a curve that has moved
+ * by any amount at all is a miss. the cache is shared between
+ * threads, and starts out with a capacity of 0, which turns it off.
+ */
+class DKIntersectionCache {
+public:
+    static DKIntersectionCache& shared();
+
+    DKIntersectionCache() : maxEntries(0) {}
+
+    // the most entries to keep. lowering it drops the
+    // least recently used entries, and 0 empties the cache
+    void setCapacity(NSUInteger capacity);
+    NSUInteger capacity() const { return maxEntries; }
+
+    // returns true and fills in intersections if the pair of curves
+    // is in the cache. each intersection is stored as it is returned
+    // by findIntersectionsBetweenBezier:andBezier:, with the t value
+    // on bez2 in x and the t value on bez1 in y
+    bool lookup(const CGPoint* bez1, const CGPoint* bez2, CGFloat precision, std::vector<CGPoint>* intersections);
+    void store(const CGPoint* bez1, const CGPoint* bez2, CGFloat precision, const std::vector<CGPoint>& intersections);
+
+    void clear();
+
+private:
+    struct Key {
+        CGPoint bez1[4];
+        CGPoint bez2[4];
+        CGFloat precision;
+
+        bool operator==(const Key& other) const;
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    struct Entry {
+        Key key;
+        std::vector<CGPoint> intersections;
+    };
+
+    static Key makeKey(const CGPoint* bez1, const CGPoint* bez2, CGFloat precision);
+    void trimToCapacity();
+
+    std::atomic<NSUInteger> maxEntries;
+    std::mutex lock;
+    // most recently used entries are at the front
+    std::list<Entry> entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+};
+
+#endif /* DKIntersectionCache_h */
@@ -0,0 +1,95 @@
+//
+//  DKIntersectionCache.mm
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#include "DKIntersectionCache.h"
+
+DKIntersectionCache& DKIntersectionCache::shared(){
+    // never destroyed, so that clipping on a background thread
+    // can't race the cache's destructor at exit
+    static DKIntersectionCache* cache = new DKIntersectionCache();
+    return *cache;
+}
+
+bool DKIntersectionCache::Key::operator==(const Key& other) const{
+    // compare bits instead of values, to match the hash
+    return memcmp(this, &other, sizeof(Key)) == 0;
+}
+
+size_t DKIntersectionCache::KeyHash::operator()(const Key& key) const{
+    // FNV-1a over the bytes of the key
+    const unsigned char* bytes = (const unsigned char*)&key;
+    uint64_t hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < sizeof(Key); i++){
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return (size_t)hash;
+}
+
+DKIntersectionCache::Key DKIntersectionCache::makeKey(const CGPoint* bez1, const CGPoint* bez2, CGFloat precision){
+    Key key;
+    // clear any padding, since the key is hashed and compared as bytes
+    memset(&key, 0, sizeof(Key));
+    memcpy(key.bez1, bez1, sizeof(key.bez1));
+    memcpy(key.bez2, bez2, sizeof(key.bez2));
+    key.precision = precision;
+    return key;
+}
+
+void DKIntersectionCache::setCapacity(NSUInteger capacity){
+    std::lock_guard<std::mutex> guard(lock);
+    maxEntries = capacity;
+    trimToCapacity();
+}
+
+bool DKIntersectionCache::lookup(const CGPoint* bez1, const CGPoint* bez2, CGFloat precision, std::vector<CGPoint>* intersections){
+    if(!maxEntries){
+        return false;
+    }
+    Key key = makeKey(bez1, bez2, precision);
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = index.find(key);
+    if(found == index.end()){
+        return false;
+    }
+    // move the entry to the front, as the most recently used
+    entries.splice(entries.begin(), entries, found->second);
+    *intersections = found->second->intersections;
+    return true;
+}
+
+void DKIntersectionCache::store(const CGPoint* bez1, const CGPoint* bez2, CGFloat precision, const std::vector<CGPoint>& intersections){
+    if(!maxEntries){
+        return;
+    }
+    Key key = makeKey(bez1, bez2, precision);
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = index.find(key);
+    if(found != index.end()){
+        // another thread found the same pair first
+        entries.splice(entries.begin(), entries, found->second);
+        found->second->intersections = intersections;
+        return;
+    }
+    entries.push_front(Entry{ key, intersections });
+    index[key] = entries.begin();
+    trimToCapacity();
+}
+
+void DKIntersectionCache::clear(){
+    std::lock_guard<std::mutex> guard(lock);
+    entries.clear();
+    index.clear();
+}
+
+void DKIntersectionCache::trimToCapacity(){
+    while(entries.size() > maxEntries){
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
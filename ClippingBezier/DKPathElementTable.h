@@ -0,0 +1,210 @@
+//
+//  DKPathElementTable.h
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#ifndef DKPathElementTable_h
+#define DKPathElementTable_h
+
+#import <UIKit/UIKit.h>
+#include <vector>
+#include "bezier-clipping.h"
+
+/**
+ * returns the exact bounds of the input cubic bezier, found
+ * from the roots of its derivative instead of from the hull
+ * of its control points
+ */
+CGRect DKTightBoundsOfBezier(const CGPoint* bez);
+
+/**
+ * fills roots with the t values in [0, 1] where one axis of a cubic
+ * bezier, with control values p0 through p3, equals value. returns the
+ * number of roots, at most 3, sorted from smallest to largest.
+ *
+ * the cubic is solved directly, and each root polished with a few
+ * newton steps. roots up to tolerance outside of [0, 1] are clamped
+ * into it, and roots closer than tolerance are merged. a bezier that's
+ * constant at value, like a line along it, returns 0.
+ */
+NSInteger DKRootsOfBezierAxisAtValue(CGFloat p0, CGFloat p1, CGFloat p2, CGFloat p3, CGFloat value, CGFloat tolerance, CGFloat* roots);
+
+/**
+ * everything the intersection code needs to know about
+ * a single element of a path
+ */
+struct DKPathElement {
+    CGPathElementType type;
+    // the element as a cubic bezier. moveTo elements
+    // have all four points at their location
+    CGPoint bez[4];
+    // the exact bounds of bez
+    CGRect bounds;
+    // the estimated arc length of bez
+    CGFloat length;
+    // which subpath of the path this element is in
+    NSInteger subpathIndex;
+    // the convex hull of bez, which the curve always lies inside.
+    // hullNormal[i] is the unit normal of the edge from hull[i] to
+    // the next hull point, and hullMin[i] and hullMax[i] are the
+    // range of the hull projected onto that normal
+    NSInteger hullCount;
+    CGPoint hull[4];
+    CGPoint hullNormal[4];
+    CGFloat hullMin[4];
+    CGFloat hullMax[4];
+    // the fat line of bez for the bezier clipping, which only
+    // depends on the element itself. constant curves don't
+    // have one
+    bool hasFatLine;
+    Geom::FatLine fatLine;
+
+    bool isLine() const {
+        return type == kCGPathElementAddLineToPoint || type == kCGPathElementCloseSubpath;
+    }
+};
+
+/**
+ * returns true if a line separates the control point hulls
+ * of the two elements with more than padding between them, in
+ * which case the two curves can't intersect. a false return
+ * doesn't mean that they do.
+ */
+bool DKControlHullsAreSeparated(const DKPathElement& element1, const DKPathElement& element2, CGFloat padding);
+
+/**
+ * the stretch where two elements run along each other. it starts
+ * at tStart1 on the first element and tStart2 on the second, and
+ * ends at tEnd1 and tEnd2. tStart1 is always less than tEnd1, but
+ * the second element may run the other way.
+ */
+struct DKElementOverlap {
+    CGFloat tStart1;
+    CGFloat tEnd1;
+    CGFloat tStart2;
+    CGFloat tEnd2;
+};
+
+/**
+ * returns true if some stretch of the two elements lies within
+ * tolerance of each other, and fills in the overlap. the bezier
+ * clipping would find a cluster of roots all along such a stretch,
+ * when only its two ends are worth reporting.
+ *
+ * an overlap always begins and ends at an end point of one of
+ * the elements, so elements that only touch or cross never pay
+ * for more than a few fat line checks.
+ */
+bool DKOverlapOfElements(const DKPathElement& element1, const DKPathElement& element2, CGFloat tolerance, DKElementOverlap* overlap);
+
+/**
+ * a table of every element of a path, with its bezier,
+ * bounds and length worked out up front. the intersection
+ * code compares every element of one path to every element
+ * of another, so anything computed per element here is
+ * computed once instead of once per pair.
+ *
+ * the table is a snapshot, and won't see later changes
+ * to the path that it was built from.
+ *
+ * fat lines are computed at clippingPrecision, which needs to be
+ * the same precision that the elements are later clipped at.
+ */
+class DKPathElementTable {
+public:
+    DKPathElementTable(UIBezierPath* path, CGFloat clippingPrecision);
+    // a table with only the type, bezier, bounds and subpath of each
+    // element, for the distance queries that never clip the elements.
+    // the hulls and fat lines are left empty, and every length is 0
+    explicit DKPathElementTable(UIBezierPath* path);
+
+    NSInteger count() const { return (NSInteger)elements.size(); }
+    const DKPathElement& operator[](NSInteger index) const { return elements[index]; }
+
+    // the union of the bounds of all drawing elements
+    CGRect bounds() const { return pathBounds; }
+    // the sum of the lengths of all elements
+    CGFloat length() const { return pathLength; }
+
+private:
+    void fillElements(UIBezierPath* path, bool boundsOnly, CGFloat clippingPrecision);
+
+    std::vector<DKPathElement> elements;
+    CGRect pathBounds;
+    CGFloat pathLength;
+};
+
+/**
+ * a bounding volume hierarchy over the drawing elements of a
+ * table, so that two paths can be searched for their closest
+ * elements without comparing every element of one to every
+ * element of the other. each node holds the union of the exact
+ * bounds of the elements below it, and each leaf only a couple
+ * of elements. move to elements aren't included.
+ *
+ * the tree refers to the table, which needs to outlive it.
+ */
+class DKPathElementTree {
+public:
+    struct Node {
+        CGRect bounds;
+        // the children of an inner node, which are both -1 for leaves
+        NSInteger left;
+        NSInteger right;
+        // the range of elementIndexes that a leaf holds
+        NSInteger first;
+        NSInteger count;
+
+        bool isLeaf() const { return left < 0; }
+    };
+
+    DKPathElementTree(const DKPathElementTable& table);
+
+    const DKPathElementTable& table() const { return elementTable; }
+    bool isEmpty() const { return nodes.empty(); }
+    // the root is always the first node
+    const Node& node(NSInteger index) const { return nodes[index]; }
+    // the index into the table of the index'th element of the leaves
+    NSInteger elementIndex(NSInteger index) const { return elementIndexes[index]; }
+
+private:
+    NSInteger buildNode(NSInteger first, NSInteger count);
+
+    const DKPathElementTable& elementTable;
+    std::vector<Node> nodes;
+    std::vector<NSInteger> elementIndexes;
+};
+
+/**
+ * the closest points between two paths, as the element
+ * and t value of the point on each
+ */
+struct DKClosestElementPoints {
+    NSInteger elementIndex1;
+    CGFloat tValue1;
+    NSInteger elementIndex2;
+    CGFloat tValue2;
+    CGFloat distance;
+};
+
+/**
+ * finds the closest points between the elements of the two trees
+ * with a branch and bound search. pairs of nodes, elements, and then
+ * halves of curves are skipped once the distance between their bounds
+ * can't beat the closest points found so far by more than tolerance,
+ * so the distance found is within tolerance of the true minimum.
+ *
+ * when threshold isn't negative, the search only looks for any pair of
+ * points that's within threshold, and stops at the first one that it
+ * finds. it always finds curves that are within threshold, but may also
+ * accept curves that are up to threshold plus tolerance apart. returns
+ * false if either tree is empty, or if no pair within threshold was
+ * found. closest, if given, is always filled in, with a distance of
+ * CGFLOAT_MAX and element indexes of -1 if nothing was compared.
+ */
+bool DKClosestPointsOfTrees(const DKPathElementTree& tree1, const DKPathElementTree& tree2, CGFloat tolerance, CGFloat threshold, DKClosestElementPoints* closest);
+
+#endif /* DKPathElementTable_h */
@@ -0,0 +1,656 @@
+//
+//  DKPathElementTable.mm
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#import "DKPathElementTable.h"
+#import "UIBezierPath+Clipping_Private.h"
+#import <PerformanceBezier/PerformanceBezier.h>
+#include "interval.h"
+#include "point.h"
+#include "bezier-clipping.h"
+#include "NearestPoint.h"
+#include <algorithm>
+
+// the number of points between the ends of a possible
+// overlap that need to lie on both elements
+#define kDKElementOverlapSamples 8
+
+/**
+ * adds the point at t along a single axis of the bezier
+ * to the running min and max for that axis
+ */
+static void includeAxisValueAtT(CGFloat t, CGFloat p0, CGFloat p1, CGFloat p2, CGFloat p3, CGFloat* minVal, CGFloat* maxVal){
+    if(t <= 0 || t >= 1){
+        // the end points are already included
+        return;
+    }
+    CGFloat mt = 1 - t;
+    CGFloat val = mt * mt * mt * p0 + 3 * mt * mt * t * p1 + 3 * mt * t * t * p2 + t * t * t * p3;
+    *minVal = MIN(*minVal, val);
+    *maxVal = MAX(*maxVal, val);
+}
+
+/**
+ * the extremes along one axis are at the end points, or where
+ * the derivative is zero. the derivative of a cubic is the
+ * quadratic a*t^2 + b*t + c, which we solve here.
+ */
+static void axisExtremesOfBezier(CGFloat p0, CGFloat p1, CGFloat p2, CGFloat p3, CGFloat* minVal, CGFloat* maxVal){
+    *minVal = MIN(p0, p3);
+    *maxVal = MAX(p0, p3);
+    if(p1 >= *minVal && p1 <= *maxVal && p2 >= *minVal && p2 <= *maxVal){
+        // the control points are inside the end points, so the
+        // curve can't go past them
+        return;
+    }
+    CGFloat a = 3 * (-p0 + 3 * p1 - 3 * p2 + p3);
+    CGFloat b = 6 * (p0 - 2 * p1 + p2);
+    CGFloat c = 3 * (p1 - p0);
+    if(ABS(a) < 1e-12){
+        if(ABS(b) > 1e-12){
+            includeAxisValueAtT(-c / b, p0, p1, p2, p3, minVal, maxVal);
+        }
+        return;
+    }
+    CGFloat discriminant = b * b - 4 * a * c;
+    if(discriminant < 0){
+        return;
+    }
+    CGFloat root = sqrt(discriminant);
+    includeAxisValueAtT((-b + root) / (2 * a), p0, p1, p2, p3, minVal, maxVal);
+    includeAxisValueAtT((-b - root) / (2 * a), p0, p1, p2, p3, minVal, maxVal);
+}
+
+CGRect DKTightBoundsOfBezier(const CGPoint* bez){
+    CGFloat minX, maxX, minY, maxY;
+    axisExtremesOfBezier(bez[0].x, bez[1].x, bez[2].x, bez[3].x, &minX, &maxX);
+    axisExtremesOfBezier(bez[0].y, bez[1].y, bez[2].y, bez[3].y, &minY, &maxY);
+    return CGRectMake(minX, minY, maxX - minX, maxY - minY);
+}
+
+NSInteger DKRootsOfBezierAxisAtValue(CGFloat p0, CGFloat p1, CGFloat p2, CGFloat p3, CGFloat value, CGFloat tolerance, CGFloat* roots){
+    // the curve lies within the hull of its control
+    // values, so it can't reach a value outside of them
+    if(MIN(MIN(p0, p1), MIN(p2, p3)) > value || MAX(MAX(p0, p1), MAX(p2, p3)) < value){
+        return 0;
+    }
+    // the coefficients of a*t^3 + b*t^2 + c*t + d
+    double a = -p0 + 3 * p1 - 3 * p2 + p3;
+    double b = 3 * p0 - 6 * p1 + 3 * p2;
+    double c = -3 * p0 + 3 * p1;
+    double d = p0 - value;
+    double scale = MAX(MAX(ABS(a), ABS(b)), MAX(ABS(c), ABS(d)));
+    if(scale == 0){
+        return 0;
+    }
+    double epsilon = scale * 1e-12;
+    
+    double candidates[3];
+    NSInteger candidateCount = 0;
+    if(ABS(a) > epsilon){
+        // cubic, solved with the trigonometric method when it
+        // has three real roots, and with cardano's when it has one
+        double B = b / a;
+        double C = c / a;
+        double D = d / a;
+        double Q = (3 * C - B * B) / 9;
+        double R = (9 * B * C - 27 * D - 2 * B * B * B) / 54;
+        double discriminant = Q * Q * Q + R * R;
+        if(discriminant > 0){
+            double sqrtDiscriminant = sqrt(discriminant);
+            candidates[candidateCount++] = -B / 3 + cbrt(R + sqrtDiscriminant) + cbrt(R - sqrtDiscriminant);
+        }else if(Q == 0){
+            candidates[candidateCount++] = -B / 3;
+        }else{
+            double theta = acos(MAX(-1.0, MIN(1.0, R / sqrt(-Q * Q * Q))));
+            double radius = 2 * sqrt(-Q);
+            candidates[candidateCount++] = radius * cos(theta / 3) - B / 3;
+            candidates[candidateCount++] = radius * cos((theta + 2 * M_PI) / 3) - B / 3;
+            candidates[candidateCount++] = radius * cos((theta + 4 * M_PI) / 3) - B / 3;
+        }
+    }else if(ABS(b) > epsilon){
+        double discriminant = c * c - 4 * b * d;
+        if(discriminant >= 0){
+            // avoid cancellation between -c and the square root
+            double q = -(c + (c < 0 ? -1 : 1) * sqrt(discriminant)) / 2;
+            candidates[candidateCount++] = q / b;
+            if(q != 0){
+                candidates[candidateCount++] = d / q;
+            }
+        }
+    }else if(ABS(c) > epsilon){
+        candidates[candidateCount++] = -d / c;
+    }
+    
+    NSInteger rootCount = 0;
+    for(NSInteger i = 0; i < candidateCount; i++){
+        double t = candidates[i];
+        for(int step = 0; step < 3; step++){
+            double f = ((a * t + b) * t + c) * t + d;
+            double df = (3 * a * t + 2 * b) * t + c;
+            if(df == 0){
+                break;
+            }
+            t -= f / df;
+        }
+        if(t < -tolerance || t > 1 + tolerance){
+            continue;
+        }
+        t = MAX(0.0, MIN(1.0, t));
+        BOOL isDuplicate = NO;
+        for(NSInteger j = 0; j < rootCount; j++){
+            isDuplicate = isDuplicate || ABS(roots[j] - t) < tolerance;
+        }
+        if(!isDuplicate){
+            roots[rootCount++] = t;
+        }
+    }
+    std::sort(roots, roots + rootCount);
+    return rootCount;
+}
+
+/**
+ * fills in the control point hull of the element, along with
+ * the normal and projected range for each of its edges
+ */
+static void fillControlHullOfElement(DKPathElement* element){
+    std::vector<Geom::Point> points(4);
+    for(int i=0;i<4;i++){
+        points[i] = Geom::Point(element->bez[i].x, element->bez[i].y);
+    }
+    Geom::convex_hull(points);
+
+    element->hullCount = 0;
+    for(size_t i=0;i<points.size() && element->hullCount < 4;i++){
+        element->hull[element->hullCount++] = CGPointMake(points[i][Geom::X], points[i][Geom::Y]);
+    }
+    for(NSInteger i=0;i<element->hullCount;i++){
+        CGPoint p1 = element->hull[i];
+        CGPoint p2 = element->hull[(i + 1) % element->hullCount];
+        CGFloat len = sqrt((p2.x - p1.x) * (p2.x - p1.x) + (p2.y - p1.y) * (p2.y - p1.y));
+        if(len == 0){
+            // duplicate points don't give us an axis
+            element->hullNormal[i] = CGPointZero;
+            element->hullMin[i] = element->hullMax[i] = 0;
+            continue;
+        }
+        CGPoint normal = CGPointMake((p1.y - p2.y) / len, (p2.x - p1.x) / len);
+        element->hullNormal[i] = normal;
+        element->hullMin[i] = CGFLOAT_MAX;
+        element->hullMax[i] = -CGFLOAT_MAX;
+        for(NSInteger j=0;j<element->hullCount;j++){
+            CGFloat dot = normal.x * element->hull[j].x + normal.y * element->hull[j].y;
+            element->hullMin[i] = MIN(element->hullMin[i], dot);
+            element->hullMax[i] = MAX(element->hullMax[i], dot);
+        }
+    }
+}
+
+/**
+ * returns true if the other element's hull lies entirely to one
+ * side of the element's hull along one of its edge normals
+ */
+static bool hullHasSeparatingEdge(const DKPathElement& element, const DKPathElement& other, CGFloat padding){
+    for(NSInteger i=0;i<element.hullCount;i++){
+        CGPoint normal = element.hullNormal[i];
+        if(normal.x == 0 && normal.y == 0){
+            continue;
+        }
+        CGFloat otherMin = CGFLOAT_MAX;
+        CGFloat otherMax = -CGFLOAT_MAX;
+        for(NSInteger j=0;j<other.hullCount;j++){
+            CGFloat dot = normal.x * other.hull[j].x + normal.y * other.hull[j].y;
+            otherMin = MIN(otherMin, dot);
+            otherMax = MAX(otherMax, dot);
+        }
+        if(otherMin > element.hullMax[i] + padding || otherMax < element.hullMin[i] - padding){
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DKControlHullsAreSeparated(const DKPathElement& element1, const DKPathElement& element2, CGFloat padding){
+    // two convex shapes are disjoint only if one of
+    // their edges is a separating axis
+    return hullHasSeparatingEdge(element1, element2, padding) || hullHasSeparatingEdge(element2, element1, padding);
+}
+
+
+static CGPoint pointOnBezierAtT(const CGPoint* bez, CGFloat t){
+    CGFloat mt = 1 - t;
+    CGFloat a = mt * mt * mt;
+    CGFloat b = 3 * mt * mt * t;
+    CGFloat c = 3 * mt * t * t;
+    CGFloat d = t * t * t;
+    return CGPointMake(a * bez[0].x + b * bez[1].x + c * bez[2].x + d * bez[3].x,
+                       a * bez[0].y + b * bez[1].y + c * bez[2].y + d * bez[3].y);
+}
+
+/**
+ * a point can only be on the curve if it's inside both of
+ * the curve's fat lines, which is much cheaper to check than
+ * finding the nearest point on the curve
+ */
+static bool pointIsInsideFatLines(CGPoint p, const Geom::FatLine& fatLine, CGFloat tolerance){
+    CGFloat dist = fatLine.line[0] * p.x + fatLine.line[1] * p.y + fatLine.line[2];
+    if(dist < fatLine.bound.min() - tolerance || dist > fatLine.bound.max() + tolerance){
+        return false;
+    }
+    dist = fatLine.perp_line[0] * p.x + fatLine.perp_line[1] * p.y + fatLine.perp_line[2];
+    return dist >= fatLine.perp_bound.min() - tolerance && dist <= fatLine.perp_bound.max() + tolerance;
+}
+
+/**
+ * returns true and the t value of the nearest point on the
+ * element if p is within tolerance of the element
+ */
+static bool projectPointOntoElement(CGPoint p, const DKPathElement& element, CGFloat tolerance, CGFloat* t){
+    double nearestT = 0;
+    CGPoint nearest = NearestPointOnCurve(p, element.bez, &nearestT);
+    CGFloat dx = nearest.x - p.x;
+    CGFloat dy = nearest.y - p.y;
+    if(dx * dx + dy * dy > tolerance * tolerance){
+        return false;
+    }
+    *t = nearestT;
+    return true;
+}
+
+bool DKOverlapOfElements(const DKPathElement& element1, const DKPathElement& element2, CGFloat tolerance, DKElementOverlap* overlap){
+    if(!element1.hasFatLine || !element2.hasFatLine){
+        return false;
+    }
+    // an overlap can only start or end at one of the four end points,
+    // and needs two of them inside the fat lines of the other element
+    bool startOfElement1 = pointIsInsideFatLines(element1.bez[0], element2.fatLine, tolerance);
+    bool endOfElement1 = pointIsInsideFatLines(element1.bez[3], element2.fatLine, tolerance);
+    bool startOfElement2 = pointIsInsideFatLines(element2.bez[0], element1.fatLine, tolerance);
+    bool endOfElement2 = pointIsInsideFatLines(element2.bez[3], element1.fatLine, tolerance);
+    if(startOfElement1 + endOfElement1 + startOfElement2 + endOfElement2 < 2){
+        return false;
+    }
+    // find which of those end points actually lie on the other element
+    CGFloat t1[4];
+    CGFloat t2[4];
+    int count = 0;
+    CGFloat t;
+    if(startOfElement1 && projectPointOntoElement(element1.bez[0], element2, tolerance, &t)){
+        t1[count] = 0;
+        t2[count++] = t;
+    }
+    if(endOfElement1 && projectPointOntoElement(element1.bez[3], element2, tolerance, &t)){
+        t1[count] = 1;
+        t2[count++] = t;
+    }
+    if(startOfElement2 && projectPointOntoElement(element2.bez[0], element1, tolerance, &t)){
+        t1[count] = t;
+        t2[count++] = 0;
+    }
+    if(endOfElement2 && projectPointOntoElement(element2.bez[3], element1, tolerance, &t)){
+        t1[count] = t;
+        t2[count++] = 1;
+    }
+    if(count < 2){
+        return false;
+    }
+    // the overlap is between the two ends that are furthest apart
+    int first = 0;
+    int last = 0;
+    for(int i=1;i<count;i++){
+        if(t1[i] < t1[first]){
+            first = i;
+        }
+        if(t1[i] > t1[last]){
+            last = i;
+        }
+    }
+    CGPoint startPoint = pointOnBezierAtT(element1.bez, t1[first]);
+    CGPoint endPoint = pointOnBezierAtT(element1.bez, t1[last]);
+    CGFloat dx = endPoint.x - startPoint.x;
+    CGFloat dy = endPoint.y - startPoint.y;
+    if(dx * dx + dy * dy < 16 * tolerance * tolerance){
+        // the elements only touch, which the bezier
+        // clipping handles just fine
+        return false;
+    }
+    // now make sure that the elements stay together all
+    // the way from one end of the overlap to the other
+    CGFloat minT2 = MIN(t2[first], t2[last]);
+    CGFloat maxT2 = MAX(t2[first], t2[last]);
+    for(int i=1;i<kDKElementOverlapSamples;i++){
+        CGFloat sampleT1 = t1[first] + (t1[last] - t1[first]) * i / kDKElementOverlapSamples;
+        CGPoint p = pointOnBezierAtT(element1.bez, sampleT1);
+        double sampleT2 = 0;
+        CGPoint nearest = NearestPointOnCurve(p, element2.bez, &sampleT2);
+        CGFloat sdx = nearest.x - p.x;
+        CGFloat sdy = nearest.y - p.y;
+        if(sdx * sdx + sdy * sdy > tolerance * tolerance || sampleT2 < minT2 || sampleT2 > maxT2){
+            return false;
+        }
+    }
+    overlap->tStart1 = t1[first];
+    overlap->tEnd1 = t1[last];
+    overlap->tStart2 = t2[first];
+    overlap->tEnd2 = t2[last];
+    return true;
+}
+
+
+/**
+ * fills in the fat line of the element's bezier
+ */
+static void fillFatLineOfElement(DKPathElement* element, CGFloat precision){
+    std::vector<Geom::Point> points(4);
+    for(int i=0;i<4;i++){
+        points[i] = Geom::Point(element->bez[i].x, element->bez[i].y);
+    }
+    element->hasFatLine = Geom::fat_line(element->fatLine, points, precision);
+}
+
+
+DKPathElementTable::DKPathElementTable(UIBezierPath* path, CGFloat clippingPrecision) : pathBounds(CGRectNull), pathLength(0){
+    fillElements(path, false, clippingPrecision);
+}
+
+DKPathElementTable::DKPathElementTable(UIBezierPath* path) : pathBounds(CGRectNull), pathLength(0){
+    fillElements(path, true, 0);
+}
+
+void DKPathElementTable::fillElements(UIBezierPath* path, bool boundsOnly, CGFloat clippingPrecision){
+    elements.reserve([path elementCount]);
+
+    __block CGPoint lastPoint = CGPointNotFound;
+    __block CGPoint subpathStartingPoint = path.firstPoint;
+    __block NSInteger subpathIndex = -1;
+    // blocks can't capture the vector by reference, so
+    // hand it in through pointers
+    std::vector<DKPathElement>* output = &elements;
+    CGRect* outputBounds = &pathBounds;
+    CGFloat* outputLength = &pathLength;
+
+    [path iteratePathWithBlock:^(CGPathElement element, NSUInteger idx){
+        DKPathElement entry;
+        entry.type = element.type;
+        if(element.type == kCGPathElementMoveToPoint){
+            subpathStartingPoint = element.points[0];
+            subpathIndex++;
+        }
+        entry.subpathIndex = MAX(0, subpathIndex);
+        lastPoint = [UIBezierPath fillCGPoints:entry.bez
+                                   withElement:element
+                     givenElementStartingPoint:lastPoint
+                       andSubPathStartingPoint:subpathStartingPoint];
+        entry.hullCount = 0;
+        entry.hasFatLine = false;
+        entry.length = 0;
+        if(element.type == kCGPathElementMoveToPoint){
+            entry.bounds = CGRectMake(entry.bez[0].x, entry.bez[0].y, 0, 0);
+        }else{
+            entry.bounds = DKTightBoundsOfBezier(entry.bez);
+            if(!boundsOnly){
+                fillControlHullOfElement(&entry);
+                fillFatLineOfElement(&entry, clippingPrecision);
+                entry.length = [UIBezierPath estimateArcLengthOf:entry.bez withSteps:10];
+            }
+            *outputBounds = CGRectUnion(*outputBounds, entry.bounds);
+            *outputLength += entry.length;
+        }
+        output->push_back(entry);
+    }];
+}
+
+
+#pragma mark - Element Tree
+
+DKPathElementTree::DKPathElementTree(const DKPathElementTable& table) : elementTable(table){
+    for(NSInteger i = 0; i < table.count(); i++){
+        if(table[i].type != kCGPathElementMoveToPoint){
+            elementIndexes.push_back(i);
+        }
+    }
+    if(!elementIndexes.empty()){
+        nodes.reserve(2 * elementIndexes.size());
+        buildNode(0, (NSInteger)elementIndexes.size());
+    }
+}
+
+NSInteger DKPathElementTree::buildNode(NSInteger first, NSInteger count){
+    Node node;
+    node.bounds = CGRectNull;
+    for(NSInteger i = first; i < first + count; i++){
+        node.bounds = CGRectUnion(node.bounds, elementTable[elementIndexes[i]].bounds);
+    }
+    node.left = -1;
+    node.right = -1;
+    node.first = first;
+    node.count = count;
+    NSInteger nodeIndex = (NSInteger)nodes.size();
+    nodes.push_back(node);
+    if(count <= 2){
+        return nodeIndex;
+    }
+
+    // split the elements in half along the longer side
+    // of the bounds, by the centers of their own bounds
+    bool splitsX = CGRectGetWidth(node.bounds) > CGRectGetHeight(node.bounds);
+    const DKPathElementTable& table = elementTable;
+    auto middle = elementIndexes.begin() + first + count / 2;
+    std::nth_element(elementIndexes.begin() + first, middle, elementIndexes.begin() + first + count, [&table, splitsX](NSInteger a, NSInteger b){
+        return splitsX ? CGRectGetMidX(table[a].bounds) < CGRectGetMidX(table[b].bounds) : CGRectGetMidY(table[a].bounds) < CGRectGetMidY(table[b].bounds);
+    });
+    // building the children can move the nodes, so
+    // only index into them after both are built
+    NSInteger left = buildNode(first, count / 2);
+    NSInteger right = buildNode(first + count / 2, count - count / 2);
+    nodes[nodeIndex].left = left;
+    nodes[nodeIndex].right = right;
+    return nodeIndex;
+}
+
+/**
+ * the distance between the closest points of the two rects,
+ * which is 0 if they touch or overlap
+ */
+static CGFloat distanceBetweenRects(CGRect rect1, CGRect rect2){
+    CGFloat dx = MAX(0, MAX(CGRectGetMinX(rect1) - CGRectGetMaxX(rect2), CGRectGetMinX(rect2) - CGRectGetMaxX(rect1)));
+    CGFloat dy = MAX(0, MAX(CGRectGetMinY(rect1) - CGRectGetMaxY(rect2), CGRectGetMinY(rect2) - CGRectGetMaxY(rect1)));
+    return sqrt(dx * dx + dy * dy);
+}
+
+static CGRect controlBoundsOfBezier(const CGPoint* bez){
+    CGFloat minX = MIN(MIN(bez[0].x, bez[1].x), MIN(bez[2].x, bez[3].x));
+    CGFloat maxX = MAX(MAX(bez[0].x, bez[1].x), MAX(bez[2].x, bez[3].x));
+    CGFloat minY = MIN(MIN(bez[0].y, bez[1].y), MIN(bez[2].y, bez[3].y));
+    CGFloat maxY = MAX(MAX(bez[0].y, bez[1].y), MAX(bez[2].y, bez[3].y));
+    return CGRectMake(minX, minY, maxX - minX, maxY - minY);
+}
+
+static void splitBezierInHalf(const CGPoint* bez, CGPoint* left, CGPoint* right){
+    CGPoint p01 = CGPointMake((bez[0].x + bez[1].x) / 2, (bez[0].y + bez[1].y) / 2);
+    CGPoint p12 = CGPointMake((bez[1].x + bez[2].x) / 2, (bez[1].y + bez[2].y) / 2);
+    CGPoint p23 = CGPointMake((bez[2].x + bez[3].x) / 2, (bez[2].y + bez[3].y) / 2);
+    CGPoint p012 = CGPointMake((p01.x + p12.x) / 2, (p01.y + p12.y) / 2);
+    CGPoint p123 = CGPointMake((p12.x + p23.x) / 2, (p12.y + p23.y) / 2);
+    CGPoint mid = CGPointMake((p012.x + p123.x) / 2, (p012.y + p123.y) / 2);
+    left[0] = bez[0];
+    left[1] = p01;
+    left[2] = p012;
+    left[3] = mid;
+    right[0] = mid;
+    right[1] = p123;
+    right[2] = p23;
+    right[3] = bez[3];
+}
+
+/**
+ * a piece of an element, from t0 to t1
+ */
+struct DKElementPiece {
+    CGPoint bez[4];
+    CGRect bounds;
+    CGFloat t0;
+    CGFloat t1;
+};
+
+struct DKClosestPointsSearch {
+    const DKPathElementTree* tree1;
+    const DKPathElementTree* tree2;
+    CGFloat tolerance;
+    CGFloat threshold;
+    DKClosestElementPoints closest;
+    bool found;
+
+    // anything farther apart than this can be skipped
+    CGFloat cutoff() const {
+        return threshold >= 0 ? threshold : closest.distance - tolerance;
+    }
+    bool isDone() const {
+        return found && threshold >= 0;
+    }
+};
+
+static void searchPieces(DKClosestPointsSearch* search, NSInteger elementIndex1, const DKElementPiece& piece1, NSInteger elementIndex2, const DKElementPiece& piece2){
+    if(search->isDone() || distanceBetweenRects(piece1.bounds, piece2.bounds) > search->cutoff()){
+        return;
+    }
+
+    // the ends of the pieces are points on both curves,
+    // so they're the candidates for the closest points
+    for(int i = 0; i < 2; i++){
+        for(int j = 0; j < 2; j++){
+            CGFloat dist = distance(piece1.bez[i * 3], piece2.bez[j * 3]);
+            if(dist < search->closest.distance){
+                search->closest.distance = dist;
+                search->closest.elementIndex1 = elementIndex1;
+                search->closest.tValue1 = i ? piece1.t1 : piece1.t0;
+                search->closest.elementIndex2 = elementIndex2;
+                search->closest.tValue2 = j ? piece2.t1 : piece2.t0;
+                if(search->threshold < 0 || dist <= search->threshold){
+                    search->found = true;
+                }
+                if(search->isDone()){
+                    return;
+                }
+            }
+        }
+    }
+
+    // pieces this small have their ends within tolerance / 3 * √2 of
+    // every point on them, so the ends of both are within tolerance
+    // of the pieces' closest points
+    CGFloat size1 = MAX(CGRectGetWidth(piece1.bounds), CGRectGetHeight(piece1.bounds));
+    CGFloat size2 = MAX(CGRectGetWidth(piece2.bounds), CGRectGetHeight(piece2.bounds));
+    if(size1 <= search->tolerance / 3 && size2 <= search->tolerance / 3){
+        if(search->threshold >= 0){
+            // the pieces weren't skipped, so their bounds are within
+            // threshold, and the curves within threshold plus tolerance
+            search->found = true;
+        }
+        return;
+    }
+
+    // split the larger piece, and search the half
+    // that's closer to the other piece first
+    bool splitsFirst = size1 >= size2;
+    const DKElementPiece& piece = splitsFirst ? piece1 : piece2;
+    const DKElementPiece& other = splitsFirst ? piece2 : piece1;
+    DKElementPiece halves[2];
+    splitBezierInHalf(piece.bez, halves[0].bez, halves[1].bez);
+    CGFloat midT = (piece.t0 + piece.t1) / 2;
+    halves[0].t0 = piece.t0;
+    halves[0].t1 = midT;
+    halves[1].t0 = midT;
+    halves[1].t1 = piece.t1;
+    halves[0].bounds = controlBoundsOfBezier(halves[0].bez);
+    halves[1].bounds = controlBoundsOfBezier(halves[1].bez);
+    int nearer = distanceBetweenRects(halves[1].bounds, other.bounds) < distanceBetweenRects(halves[0].bounds, other.bounds) ? 1 : 0;
+    for(int i = 0; i < 2; i++){
+        const DKElementPiece& half = halves[i ? 1 - nearer : nearer];
+        if(splitsFirst){
+            searchPieces(search, elementIndex1, half, elementIndex2, other);
+        }else{
+            searchPieces(search, elementIndex1, other, elementIndex2, half);
+        }
+    }
+}
+
+static void searchElements(DKClosestPointsSearch* search, NSInteger elementIndex1, NSInteger elementIndex2){
+    const DKPathElement& element1 = search->tree1->table()[elementIndex1];
+    const DKPathElement& element2 = search->tree2->table()[elementIndex2];
+    if(distanceBetweenRects(element1.bounds, element2.bounds) > search->cutoff()){
+        return;
+    }
+    DKElementPiece piece1;
+    memcpy(piece1.bez, element1.bez, sizeof(piece1.bez));
+    piece1.bounds = controlBoundsOfBezier(piece1.bez);
+    piece1.t0 = 0;
+    piece1.t1 = 1;
+    DKElementPiece piece2;
+    memcpy(piece2.bez, element2.bez, sizeof(piece2.bez));
+    piece2.bounds = controlBoundsOfBezier(piece2.bez);
+    piece2.t0 = 0;
+    piece2.t1 = 1;
+    searchPieces(search, elementIndex1, piece1, elementIndex2, piece2);
+}
+
+static void searchNodes(DKClosestPointsSearch* search, NSInteger nodeIndex1, NSInteger nodeIndex2){
+    const DKPathElementTree::Node& node1 = search->tree1->node(nodeIndex1);
+    const DKPathElementTree::Node& node2 = search->tree2->node(nodeIndex2);
+    if(search->isDone() || distanceBetweenRects(node1.bounds, node2.bounds) > search->cutoff()){
+        return;
+    }
+    if(node1.isLeaf() && node2.isLeaf()){
+        for(NSInteger i = node1.first; i < node1.first + node1.count; i++){
+            for(NSInteger j = node2.first; j < node2.first + node2.count; j++){
+                searchElements(search, search->tree1->elementIndex(i), search->tree2->elementIndex(j));
+                if(search->isDone()){
+                    return;
+                }
+            }
+        }
+        return;
+    }
+
+    // descend into the larger node, nearer child first
+    bool descendsFirst = node2.isLeaf() || (!node1.isLeaf() && CGRectGetWidth(node1.bounds) * CGRectGetHeight(node1.bounds) >= CGRectGetWidth(node2.bounds) * CGRectGetHeight(node2.bounds));
+    const DKPathElementTree* tree = descendsFirst ? search->tree1 : search->tree2;
+    const DKPathElementTree::Node& node = descendsFirst ? node1 : node2;
+    const DKPathElementTree::Node& other = descendsFirst ? node2 : node1;
+    NSInteger children[2] = { node.left, node.right };
+    if(distanceBetweenRects(tree->node(node.right).bounds, other.bounds) < distanceBetweenRects(tree->node(node.left).bounds, other.bounds)){
+        std::swap(children[0], children[1]);
+    }
+    for(int i = 0; i < 2; i++){
+        if(descendsFirst){
+            searchNodes(search, children[i], nodeIndex2);
+        }else{
+            searchNodes(search, nodeIndex1, children[i]);
+        }
+    }
+}
+
+bool DKClosestPointsOfTrees(const DKPathElementTree& tree1, const DKPathElementTree& tree2, CGFloat tolerance, CGFloat threshold, DKClosestElementPoints* closest){
+    DKClosestPointsSearch search;
+    search.tree1 = &tree1;
+    search.tree2 = &tree2;
+    search.tolerance = tolerance;
+    search.threshold = threshold;
+    search.closest.elementIndex1 = -1;
+    search.closest.tValue1 = 0;
+    search.closest.elementIndex2 = -1;
+    search.closest.tValue2 = 0;
+    search.closest.distance = CGFLOAT_MAX;
+    search.found = false;
+    if(!tree1.isEmpty() && !tree2.isEmpty()){
+        searchNodes(&search, 0, 0);
+    }
+    if(closest){
+        *closest = search.closest;
+    }
+    return search.found;
+}
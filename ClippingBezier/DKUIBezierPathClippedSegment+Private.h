@@ -0,0 +1,40 @@
+//
+//  DKUIBezierPathClippedSegment+Private.h
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#import "DKUIBezierPathClippedSegment.h"
+#include "DKVectorValue.h"
+#include "DKPathElementTable.h"
+#include <memory>
+
+@interface DKUIBezierPathClippedSegment (Private)
+
+// a segment of the path that the table was built from, from startElement
+// at startT to endElement at endT. its pathSegment isn't built until it's
+// asked for
++(DKUIBezierPathClippedSegment*) clippedPairWithStart:(DKUIBezierPathIntersectionPoint *)_tStart
+                                               andEnd:(DKUIBezierPathIntersectionPoint *)_tEnd
+                                          fromElement:(NSInteger)startElement
+                                                  atT:(CGFloat)startT
+                                            toElement:(NSInteger)endElement
+                                                  atT:(CGFloat)endT
+                                              inTable:(std::shared_ptr<const DKPathElementTable>)table
+                                         fromFullPath:(UIBezierPath*)_fullPath;
+
+// the same stretch of path as this segment, between different
+// intersections. this doesn't build the path if it hasn't been yet
+-(DKUIBezierPathClippedSegment*) segmentWithStart:(DKUIBezierPathIntersectionPoint *)_tStart
+                                           andEnd:(DKUIBezierPathIntersectionPoint *)_tEnd
+                                     fromFullPath:(UIBezierPath*)_fullPath;
+
+// the same tangents as startVector and endVector,
+// but without allocating a DKVector
+-(DKVectorValue) startTangent;
+
+-(DKVectorValue) endTangent;
+
+@end
@@ -10,6 +10,41 @@
 #import "DKUIBezierPathIntersectionPoint.h"
 #import "DKVector.h"
 
+/**
+ * the line integrals around a path that Green's theorem turns
+ * into its area and the moments of that area:
+ *
+ *   area = ∮ (x dy - y dx) / 2
+ *   momentX = ∮ x² dy / 2
+ *   momentY = -∮ y² dx / 2
+ *
+ * integrals along pieces of a path add up to the integral around
+ * the whole path, and a closed path's centroid is
+ * (momentX / area, momentY / area).
+ */
+typedef struct {
+    CGFloat area;
+    CGFloat momentX;
+    CGFloat momentY;
+    // the ends of the path that the integrals run along
+    CGPoint startPoint;
+    CGPoint endPoint;
+} DKAreaMoments;
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/**
+ * adds the area integrals along the straight line from
+ * start to end, leaving the start and end points alone
+ */
+void DKAddAreaMomentsOfLine(DKAreaMoments* moments, CGPoint start, CGPoint end);
+
+#if defined __cplusplus
+}
+#endif
+
 /**
  * when chopping an unclosed path to a closed path, this
  * represents the segment of the original unclosed path
@@ -51,4 +86,13 @@
 
 -(BOOL) isEqualToSegment:(DKUIBezierPathClippedSegment*)otherSegment;
 
+// the area integrals along the pathSegment. reversed and joined
+// segments find these from the segments that they're made from,
+// without building their pathSegment
+-(DKAreaMoments) areaMoments;
+
+// the exact bounds of the pathSegment. like the area
+// integrals, these don't need the pathSegment to be built
+-(CGRect) bounds;
+
 @end
@@ -0,0 +1,490 @@
+//
+//  DKUIBezierPathClippedSegment.m
+//  LooseLeaf
+//
+//  Created by Adam Wulf on 10/7/13.
+//  Copyright (c) 2013 Milestone Made, LLC. All rights reserved.
+//
+
+#import "DKUIBezierPathClippedSegment.h"
+#import "DKUIBezierPathClippedSegment+Private.h"
+#import <PerformanceBezier/PerformanceBezier.h>
+#import "DKVector.h"
+#import "UIBezierPath+Clipping.h"
+#import "UIBezierPath+Clipping_Private.h"
+#import "UIBezierPath+Trimming.h"
+#include <algorithm>
+
+@implementation DKUIBezierPathClippedSegment{
+    DKUIBezierPathIntersectionPoint* startIntersection;
+    DKUIBezierPathIntersectionPoint* endIntersection;
+    UIBezierPath* pathSegment;
+    UIBezierPath* fullPath;
+    
+    // reversed and joined segments don't build their pathSegment
+    // until it's asked for, since most of them are only ever
+    // compared and then thrown away. until then, they keep
+    // the segments that it'll be built from
+    DKUIBezierPathClippedSegment* reversedSource;
+    DKUIBezierPathClippedSegment* prependedSource;
+    DKUIBezierPathClippedSegment* appendedSource;
+    
+    // the rest are a stretch of the elements of a table, from
+    // startElement at startT to endElement at endT. their bounds, area
+    // and tangents are found from those elements, so the clipping never
+    // builds their pathSegment. a segment that's given its pathSegment
+    // gets a table of all of its elements instead
+    std::shared_ptr<const DKPathElementTable> elementTable;
+    NSInteger startElement;
+    CGFloat startT;
+    NSInteger endElement;
+    CGFloat endT;
+    
+    __weak DKUIBezierPathClippedSegment* reversedFrom;
+    BOOL isReversed;
+    
+    // the tangents of the pathSegment, which are
+    // found as soon as the segment is made
+    DKVectorValue startTangent;
+    DKVectorValue endTangent;
+    
+    BOOL hasAreaMoments;
+    DKAreaMoments areaMoments;
+}
+
+@synthesize startIntersection;
+@synthesize endIntersection;
+@synthesize fullPath;
+@synthesize isReversed;
+
+-(void) setIsReversed:(BOOL)r{
+    isReversed = r;
+}
+-(void) setReversedFrom:(DKUIBezierPathClippedSegment*)r{
+    reversedFrom = r;
+}
+
++(DKUIBezierPathClippedSegment*) clippedPairWithStart:(DKUIBezierPathIntersectionPoint *)_tStart andEnd:(DKUIBezierPathIntersectionPoint *)_tEnd andPathSegment:(UIBezierPath *)segment fromFullPath:(UIBezierPath*)_fullPath{
+    return [[DKUIBezierPathClippedSegment alloc] initWithStart:_tStart andEnd:_tEnd andPathSegment:segment fromFullPath:_fullPath];
+}
+
++(DKUIBezierPathClippedSegment*) clippedPairWithStart:(DKUIBezierPathIntersectionPoint *)_tStart
+                                               andEnd:(DKUIBezierPathIntersectionPoint *)_tEnd
+                                          fromElement:(NSInteger)_startElement
+                                                  atT:(CGFloat)_startT
+                                            toElement:(NSInteger)_endElement
+                                                  atT:(CGFloat)_endT
+                                              inTable:(std::shared_ptr<const DKPathElementTable>)table
+                                         fromFullPath:(UIBezierPath*)_fullPath{
+    DKUIBezierPathClippedSegment* ret = [[DKUIBezierPathClippedSegment alloc] initWithStart:_tStart andEnd:_tEnd andPathSegment:nil fromFullPath:_fullPath];
+    ret->elementTable = table;
+    ret->startElement = _startElement;
+    ret->startT = _startT;
+    ret->endElement = _endElement;
+    ret->endT = _endT;
+    [ret calculateTangents];
+    return ret;
+}
+
+-(id) initWithStart:(DKUIBezierPathIntersectionPoint *)_tStart andEnd:(DKUIBezierPathIntersectionPoint *)_tEnd andPathSegment:(UIBezierPath *)segment fromFullPath:(UIBezierPath*)_fullPath{
+    if(self = [super init]){
+        startIntersection = _tStart;
+        endIntersection = _tEnd;
+        pathSegment = segment;
+        fullPath = _fullPath;
+        if(pathSegment){
+            [self calculateTangents];
+        }
+    }
+    return self;
+}
+
+-(DKUIBezierPathClippedSegment*) segmentWithStart:(DKUIBezierPathIntersectionPoint*)_tStart andEnd:(DKUIBezierPathIntersectionPoint*)_tEnd fromFullPath:(UIBezierPath*)_fullPath{
+    DKUIBezierPathClippedSegment* ret = [DKUIBezierPathClippedSegment clippedPairWithStart:_tStart andEnd:_tEnd andPathSegment:nil fromFullPath:_fullPath];
+    [ret setIsReversed:self.isReversed];
+    // share the same path segment, even if it hasn't been built yet
+    ret->pathSegment = pathSegment;
+    ret->reversedSource = reversedSource;
+    ret->prependedSource = prependedSource;
+    ret->appendedSource = appendedSource;
+    ret->elementTable = elementTable;
+    ret->startElement = startElement;
+    ret->startT = startT;
+    ret->endElement = endElement;
+    ret->endT = endT;
+    // same path segment, so same tangents
+    ret->startTangent = startTangent;
+    ret->endTangent = endTangent;
+    if(hasAreaMoments){
+        ret->hasAreaMoments = YES;
+        ret->areaMoments = areaMoments;
+    }
+    return ret;
+}
+
+-(DKUIBezierPathClippedSegment*) flippedRedBlueSegment{
+    return [self segmentWithStart:[startIntersection flipped] andEnd:[endIntersection flipped] fromFullPath:fullPath];
+}
+
+-(NSString*) description{
+    return [NSString stringWithFormat:@"[Segment: p1(%d:%f => %d:%f) p2(%d:%f => %d:%f)]",
+            (int)startIntersection.elementIndex1, startIntersection.tValue1, (int)endIntersection.elementIndex1, endIntersection.tValue1,
+            (int)startIntersection.elementIndex2, startIntersection.tValue2, (int)endIntersection.elementIndex2, endIntersection.tValue2];
+}
+
+-(BOOL) canBePrependedTo:(DKUIBezierPathClippedSegment*)otherPath{
+    if(otherPath.startIntersection == self.endIntersection){
+        return YES;
+    }
+    if(otherPath.startIntersection.elementIndex1 == 0 &&
+       otherPath.startIntersection.tValue1 == 0 &&
+       self.endIntersection.elementIndex1 == fullPath.elementCount - 1 &&
+       self.endIntersection.tValue1 == 1){
+        return YES;
+    }
+    return NO;
+}
+
+-(DKUIBezierPathClippedSegment*) prependTo:(DKUIBezierPathClippedSegment*)otherSegment{
+    DKUIBezierPathClippedSegment* ret = [DKUIBezierPathClippedSegment clippedPairWithStart:self.startIntersection
+                                                                                    andEnd:otherSegment.endIntersection
+                                                                            andPathSegment:nil
+                                                                              fromFullPath:self.fullPath];
+    ret->prependedSource = self;
+    ret->appendedSource = otherSegment;
+    [ret calculateTangents];
+    return ret;
+}
+
+-(DKUIBezierPathClippedSegment*) reversedSegment{
+    if(reversedFrom){
+        return reversedFrom;
+    }
+    DKUIBezierPathClippedSegment* ret = [DKUIBezierPathClippedSegment clippedPairWithStart:self.endIntersection andEnd:self.startIntersection andPathSegment:nil fromFullPath:self.fullPath];
+    ret->reversedSource = self;
+    [ret calculateTangents];
+    [ret setIsReversed:!isReversed];
+    [ret setReversedFrom:self];
+    [self setReversedFrom:ret];
+    return ret;
+}
+
+-(BOOL) isEqual:(id)object{
+    return object == self || ([object isKindOfClass:[DKUIBezierPathClippedSegment class]] && [object reversedSegment] == self);
+}
+
+-(BOOL) isEqualToSegment:(DKUIBezierPathClippedSegment*)otherSegment{
+    return [otherSegment isKindOfClass:[DKUIBezierPathClippedSegment class]] &&
+    [self.startIntersection isEqualToIntersection:otherSegment.startIntersection] &&
+    [self.endIntersection isEqualToIntersection:otherSegment.endIntersection] &&
+    self.isReversed == otherSegment.isReversed;
+}
+
+/**
+ * a segment is equal to its reversed segment, which swaps the start
+ * and end and flips isReversed, so neither order nor direction can
+ * be part of the hash
+ */
+-(NSUInteger) hash{
+    return [startIntersection hash] ^ [endIntersection hash];
+}
+
+
+/**
+ * calculates the angle between this segment's endpoint and the
+ * otherInter's startpoint
+ */
+-(CGFloat) angleBetween:(DKUIBezierPathClippedSegment*)otherInter{
+    return [self endTangent].angleBetween([otherInter startTangent]);
+}
+
+-(DKVector*) endVector{
+    DKVectorValue tangent = [self endTangent];
+    return [DKVector vectorWithX:tangent.x andY:tangent.y];
+}
+
+-(DKVector*) startVector{
+    DKVectorValue tangent = [self startTangent];
+    return [DKVector vectorWithX:tangent.x andY:tangent.y];
+}
+
+#pragma mark - Elements
+
+/**
+ * fills piece with the part of the cubic bezier from fromT to toT.
+ * this splits the bezier the same way that the clipping code always
+ * has: first at fromT, and then what's right of that at toT
+ * rescaled to it
+ */
+static void pieceOfBezier(const CGPoint* bez, CGFloat fromT, CGFloat toT, CGPoint* piece){
+    CGPoint left[4];
+    CGPoint right[4];
+    std::copy(bez, bez + 4, piece);
+    if(fromT > 0){
+        [UIBezierPath subdivideBezier:piece intoLeft:left andRight:right atT:fromT];
+        std::copy(right, right + 4, piece);
+    }
+    if(toT < 1){
+        [UIBezierPath subdivideBezier:piece intoLeft:left andRight:right atT:(toT - fromT) / (1.0 - fromT)];
+        std::copy(left, left + 4, piece);
+    }
+}
+
+/**
+ * the pathSegment of a segment that wasn't given one covers
+ * all of the elements of its full path
+ */
+-(void) buildElementTableIfNeeded{
+    if(!elementTable && pathSegment && !reversedSource && !prependedSource){
+        elementTable = std::make_shared<DKPathElementTable>(pathSegment);
+        startElement = 0;
+        startT = 0;
+        endElement = elementTable->count() - 1;
+        endT = 1;
+    }
+}
+
+/**
+ * the point that the segment's elements start from
+ */
+-(CGPoint) startPointOfElements{
+    if(startElement >= elementTable->count()){
+        return CGPointZero;
+    }
+    CGPoint piece[4];
+    pieceOfBezier((*elementTable)[startElement].bez, startT, 1, piece);
+    return piece[0];
+}
+
+/**
+ * calls block with each piece of the segment's elements, in order,
+ * as a cubic bezier. elements between the ends are always included
+ * whole, even if they have no length, but the pieces of the end
+ * elements only if they cover more than a single t value. move to
+ * elements are skipped
+ */
+-(void) enumeratePiecesOfElementsWithBlock:(void(^)(const CGPoint* bez, BOOL isLine))block{
+    if(!elementTable){
+        return;
+    }
+    for(NSInteger index = startElement; index <= endElement; index++){
+        const DKPathElement& element = (*elementTable)[index];
+        CGFloat fromT = index == startElement ? startT : 0;
+        CGFloat toT = index == endElement ? endT : 1;
+        if(element.type == kCGPathElementMoveToPoint || toT <= fromT){
+            continue;
+        }
+        CGPoint piece[4];
+        pieceOfBezier(element.bez, fromT, toT, piece);
+        block(piece, element.isLine());
+    }
+}
+
+-(UIBezierPath*) pathSegment{
+    if(!pathSegment){
+        if(reversedSource){
+            pathSegment = [reversedSource.pathSegment bezierPathByReversingPath];
+        }else if(prependedSource){
+            pathSegment = [prependedSource.pathSegment copy];
+            [pathSegment appendPathRemovingInitialMoveToPoint:appendedSource.pathSegment];
+        }else if(elementTable){
+            UIBezierPath* path = [UIBezierPath bezierPath];
+            [path moveToPoint:[self startPointOfElements]];
+            [self enumeratePiecesOfElementsWithBlock:^(const CGPoint* bez, BOOL isLine){
+                if(isLine){
+                    [path addLineToPoint:bez[3]];
+                }else{
+                    [path addCurveToPoint:bez[3] controlPoint1:bez[1] controlPoint2:bez[2]];
+                }
+            }];
+            pathSegment = path;
+        }
+        reversedSource = nil;
+        prependedSource = nil;
+        appendedSource = nil;
+    }
+    return pathSegment;
+}
+
+-(CGRect) bounds{
+    if(reversedSource){
+        return [reversedSource bounds];
+    }else if(prependedSource){
+        return CGRectUnion([prependedSource bounds], [appendedSource bounds]);
+    }
+    [self buildElementTableIfNeeded];
+    if(!elementTable){
+        return CGRectNull;
+    }
+    CGPoint startPoint = [self startPointOfElements];
+    __block CGRect bounds = CGRectMake(startPoint.x, startPoint.y, 0, 0);
+    [self enumeratePiecesOfElementsWithBlock:^(const CGPoint* bez, BOOL isLine){
+        bounds = CGRectUnion(bounds, DKTightBoundsOfBezier(bez));
+    }];
+    return bounds;
+}
+
+/**
+ * the tangent of the reversed path at the same point. subtracting
+ * from zero instead of negating keeps zeros positive, the same as
+ * a tangent measured from the reversed path itself
+ */
+static DKVectorValue reversedTangent(DKVectorValue tangent){
+    return DKVectorValue(0 - tangent.x, 0 - tangent.y);
+}
+
+/**
+ * the direction that the bezier leaves bez[0] in. if the first
+ * control point sits on top of it, then the direction is towards
+ * the next control point that doesn't. a bezier that's only a
+ * single point returns NO
+ */
+static BOOL directionAtStartOfBezier(const CGPoint* bez, DKVectorValue* direction){
+    for(int i = 1; i < 4; i++){
+        if(!CGPointEqualToPoint(bez[i], bez[0])){
+            *direction = DKVectorValue(bez[0], bez[i]).normal();
+            return YES;
+        }
+    }
+    return NO;
+}
+
+/**
+ * the direction that the bezier arrives at bez[3] from
+ */
+static BOOL directionAtEndOfBezier(const CGPoint* bez, DKVectorValue* direction){
+    for(int i = 2; i >= 0; i--){
+        if(!CGPointEqualToPoint(bez[i], bez[3])){
+            *direction = DKVectorValue(bez[i], bez[3]).normal();
+            return YES;
+        }
+    }
+    return NO;
+}
+
+/**
+ * the tangents are the exact directions that the path leaves its start
+ * and arrives at its end in. pieces that are only a single point, like
+ * a line to where the path already is, are skipped, since they don't
+ * go in any direction. a path that's only a single point has zero
+ * tangents
+ */
+-(void) calculateTangents{
+    if(reversedSource){
+        // the reversed path has the same tangents as
+        // the source path, just swapped and flipped
+        startTangent = reversedTangent([reversedSource endTangent]);
+        endTangent = reversedTangent([reversedSource startTangent]);
+    }else if(prependedSource){
+        // a joined path leaves in the direction of its first half
+        // and arrives in the direction of its second, unless
+        // either half is only a single point
+        startTangent = [prependedSource startTangent];
+        if(startTangent.x == 0 && startTangent.y == 0){
+            startTangent = [appendedSource startTangent];
+        }
+        endTangent = [appendedSource endTangent];
+        if(endTangent.x == 0 && endTangent.y == 0){
+            endTangent = [prependedSource endTangent];
+        }
+    }else{
+        [self buildElementTableIfNeeded];
+        __block BOOL hasStart = NO;
+        __block DKVectorValue start;
+        __block DKVectorValue end;
+        [self enumeratePiecesOfElementsWithBlock:^(const CGPoint* bez, BOOL isLine){
+            DKVectorValue direction;
+            if(directionAtEndOfBezier(bez, &direction)){
+                end = direction;
+                if(!hasStart){
+                    directionAtStartOfBezier(bez, &start);
+                    hasStart = YES;
+                }
+            }
+        }];
+        startTangent = start;
+        endTangent = end;
+    }
+}
+
+-(DKVectorValue) startTangent{
+    return startTangent;
+}
+
+-(DKVectorValue) endTangent{
+    return endTangent;
+}
+
+#pragma mark - Area
+
+/**
+ * adds the area integrals along the cubic bezier. every integrand
+ * is a polynomial in t of degree at most 8, so 5 point
+ * Gauss-Legendre quadrature finds them exactly
+ */
+static void addAreaMomentsOfBezier(DKAreaMoments* moments, const CGPoint* bez){
+    static const CGFloat nodes[5] = { 0.5, 0.2307653449471585, 0.7692346550528415, 0.0469100770306680, 0.9530899229693320 };
+    static const CGFloat weights[5] = { 0.2844444444444444, 0.2393143352496832, 0.2393143352496832, 0.1184634425280945, 0.1184634425280945 };
+    for(int i = 0; i < 5; i++){
+        CGFloat t = nodes[i];
+        CGFloat mt = 1 - t;
+        CGFloat x = mt * mt * mt * bez[0].x + 3 * mt * mt * t * bez[1].x + 3 * mt * t * t * bez[2].x + t * t * t * bez[3].x;
+        CGFloat y = mt * mt * mt * bez[0].y + 3 * mt * mt * t * bez[1].y + 3 * mt * t * t * bez[2].y + t * t * t * bez[3].y;
+        CGFloat dx = 3 * (mt * mt * (bez[1].x - bez[0].x) + 2 * mt * t * (bez[2].x - bez[1].x) + t * t * (bez[3].x - bez[2].x));
+        CGFloat dy = 3 * (mt * mt * (bez[1].y - bez[0].y) + 2 * mt * t * (bez[2].y - bez[1].y) + t * t * (bez[3].y - bez[2].y));
+        moments->area += weights[i] * (x * dy - y * dx) / 2;
+        moments->momentX += weights[i] * x * x * dy / 2;
+        moments->momentY -= weights[i] * y * y * dx / 2;
+    }
+}
+
+void DKAddAreaMomentsOfLine(DKAreaMoments* moments, CGPoint start, CGPoint end){
+    moments->area += (start.x * end.y - end.x * start.y) / 2;
+    moments->momentX += (end.y - start.y) * (start.x * start.x + start.x * end.x + end.x * end.x) / 6;
+    moments->momentY -= (end.x - start.x) * (start.y * start.y + start.y * end.y + end.y * end.y) / 6;
+}
+
+-(DKAreaMoments) areaMoments{
+    if(!hasAreaMoments){
+        DKAreaMoments moments = { 0, 0, 0, CGPointZero, CGPointZero };
+        if(reversedSource){
+            DKAreaMoments sourceMoments = [reversedSource areaMoments];
+            moments.area = -sourceMoments.area;
+            moments.momentX = -sourceMoments.momentX;
+            moments.momentY = -sourceMoments.momentY;
+            moments.startPoint = sourceMoments.endPoint;
+            moments.endPoint = sourceMoments.startPoint;
+        }else if(prependedSource){
+            // both halves meet at the same intersection, so
+            // their integrals add up without a gap between them
+            DKAreaMoments prependedMoments = [prependedSource areaMoments];
+            DKAreaMoments appendedMoments = [appendedSource areaMoments];
+            moments.area = prependedMoments.area + appendedMoments.area;
+            moments.momentX = prependedMoments.momentX + appendedMoments.momentX;
+            moments.momentY = prependedMoments.momentY + appendedMoments.momentY;
+            moments.startPoint = prependedMoments.startPoint;
+            moments.endPoint = appendedMoments.endPoint;
+        }else{
+            [self buildElementTableIfNeeded];
+            if(elementTable){
+                __block DKAreaMoments pathMoments = moments;
+                pathMoments.startPoint = [self startPointOfElements];
+                pathMoments.endPoint = pathMoments.startPoint;
+                [self enumeratePiecesOfElementsWithBlock:^(const CGPoint* bez, BOOL isLine){
+                    if(isLine){
+                        DKAddAreaMomentsOfLine(&pathMoments, bez[0], bez[3]);
+                    }else{
+                        addAreaMomentsOfBezier(&pathMoments, bez);
+                    }
+                    pathMoments.endPoint = bez[3];
+                }];
+                moments = pathMoments;
+            }
+        }
+        areaMoments = moments;
+        hasAreaMoments = YES;
+    }
+    return areaMoments;
+}
+
+@end
@@ -0,0 +1,33 @@
+//
+//  DKUIBezierPathClippingOperation.h
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * the name of the exception that unwinds a clipping
+ * operation after it's been cancelled. it's caught before
+ * it leaves the asynchronous methods, so callers only see
+ * it if they cancel synchronous work themselves.
+ */
+extern NSString* const DKUIBezierPathClippingCancelledException;
+
+/**
+ * the handle for an asynchronous slice or clip. cancelling it
+ * stops the work at its next loop boundary, and its completion
+ * block won't be called.
+ */
+@interface DKUIBezierPathClippingOperation : NSObject
+
+@property (readonly) BOOL isCancelled;
+
+/**
+ * safe to call from any thread, and more than once
+ */
+-(void) cancel;
+
+@end
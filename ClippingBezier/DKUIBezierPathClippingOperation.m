@@ -0,0 +1,27 @@
+//
+//  DKUIBezierPathClippingOperation.m
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#import "DKUIBezierPathClippingOperation.h"
+
+NSString* const DKUIBezierPathClippingCancelledException = @"DKUIBezierPathClippingCancelledException";
+
+@interface DKUIBezierPathClippingOperation ()
+
+@property (readwrite) BOOL isCancelled;
+
+@end
+
+@implementation DKUIBezierPathClippingOperation
+
+@synthesize isCancelled;
+
+-(void) cancel{
+    self.isCancelled = YES;
+}
+
+@end
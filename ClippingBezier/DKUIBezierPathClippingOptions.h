@@ -0,0 +1,51 @@
+//
+//  DKUIBezierPathClippingOptions.h
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+/**
+ * optional settings for the slicing and clipping
+ * methods in UIBezierPath+Clipping. the defaultOptions
+ * give the exact same results as the methods that
+ * don't take any options.
+ */
+@interface DKUIBezierPathClippingOptions : NSObject <NSCopying>
+
+/**
+ * when greater than zero, both the scissor and the shape
+ * are simplified before they're clipped by refitting runs
+ * of their elements with curves that stay within this
+ * distance of the original path.
+ *
+ * defaults to 0, which leaves the paths untouched
+ */
+@property (nonatomic, assign) CGFloat simplificationTolerance;
+
+/**
+ * elements that meet at an angle larger than this (in radians)
+ * are kept as corners during simplification, and never
+ * merged into the same curve.
+ *
+ * defaults to M_PI / 6
+ */
+@property (nonatomic, assign) CGFloat simplificationCornerAngle;
+
+/**
+ * when greater than zero, shapes made by slicing whose area
+ * is smaller than this are thrown away before they're matched
+ * with their holes, so that the slivers left over where a
+ * scissor runs along an edge never show up in the results.
+ *
+ * defaults to 0, which keeps every shape
+ */
+@property (nonatomic, assign) CGFloat minimumArea;
+
++(DKUIBezierPathClippingOptions*) defaultOptions;
+
+@end
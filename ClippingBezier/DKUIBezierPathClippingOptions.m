@@ -0,0 +1,38 @@
+//
+//  DKUIBezierPathClippingOptions.m
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#import "DKUIBezierPathClippingOptions.h"
+
+@implementation DKUIBezierPathClippingOptions
+
+@synthesize simplificationTolerance;
+@synthesize simplificationCornerAngle;
+@synthesize minimumArea;
+
++(DKUIBezierPathClippingOptions*) defaultOptions{
+    return [[DKUIBezierPathClippingOptions alloc] init];
+}
+
+-(id) init{
+    if(self = [super init]){
+        simplificationTolerance = 0;
+        simplificationCornerAngle = M_PI / 6;
+        minimumArea = 0;
+    }
+    return self;
+}
+
+-(id) copyWithZone:(NSZone *)zone{
+    DKUIBezierPathClippingOptions* ret = [[[self class] allocWithZone:zone] init];
+    ret.simplificationTolerance = simplificationTolerance;
+    ret.simplificationCornerAngle = simplificationCornerAngle;
+    ret.minimumArea = minimumArea;
+    return ret;
+}
+
+@end
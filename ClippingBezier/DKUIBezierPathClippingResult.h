@@ -34,4 +34,12 @@
        andShellIntSegments:(NSUInteger)_numberOfShellIntersectionSegments
       andShellDiffSegments:(NSUInteger)_numberOfShellDifferenceSegments;
 
+// the entire intersection and difference paths are each of the
+// segments' paths appended together, and are only built the first
+// time that they're asked for
+-(id) initWithIntersectionSegments:(NSArray*)_intersectionSegments
+             andDifferenceSegments:(NSArray*)_differenceSegments
+               andShellIntSegments:(NSUInteger)_numberOfShellIntersectionSegments
+              andShellDiffSegments:(NSUInteger)_numberOfShellDifferenceSegments;
+
 @end
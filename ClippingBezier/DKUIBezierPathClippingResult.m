@@ -7,6 +7,8 @@
 //
 
 #import "DKUIBezierPathClippingResult.h"
+#import "DKUIBezierPathClippedSegment.h"
+#import <PerformanceBezier/PerformanceBezier.h>
 
 @implementation DKUIBezierPathClippingResult{
     UIBezierPath* entireIntersectionPath;
@@ -19,8 +21,6 @@
     NSUInteger numberOfShellDifferenceSegments;
 }
 
-@synthesize entireIntersectionPath;
-@synthesize entireDifferencePath;
 @synthesize differenceSegments;
 @synthesize intersectionSegments;
 @synthesize numberOfShellIntersectionSegments;
@@ -43,4 +43,44 @@
     return self;
 }
 
+-(id) initWithIntersectionSegments:(NSArray*)_intersectionSegments
+             andDifferenceSegments:(NSArray*)_differenceSegments
+               andShellIntSegments:(NSUInteger)_numberOfShellIntersectionSegments
+              andShellDiffSegments:(NSUInteger)_numberOfShellDifferenceSegments{
+    return [self initWithIntersection:nil
+                          andSegments:_intersectionSegments
+                        andDifference:nil
+                          andSegments:_differenceSegments
+                  andShellIntSegments:_numberOfShellIntersectionSegments
+                 andShellDiffSegments:_numberOfShellDifferenceSegments];
+}
+
+/**
+ * appends the path of every segment that's more
+ * than just its move to
+ */
+static UIBezierPath* entirePathOfSegments(NSArray* segments){
+    UIBezierPath* path = [UIBezierPath bezierPath];
+    for(DKUIBezierPathClippedSegment* seg in segments){
+        if([seg.pathSegment elementCount] > 1){
+            [path appendPath:seg.pathSegment];
+        }
+    }
+    return path;
+}
+
+-(UIBezierPath*) entireIntersectionPath{
+    if(!entireIntersectionPath){
+        entireIntersectionPath = entirePathOfSegments(intersectionSegments);
+    }
+    return entireIntersectionPath;
+}
+
+-(UIBezierPath*) entireDifferencePath{
+    if(!entireDifferencePath){
+        entireDifferencePath = entirePathOfSegments(differenceSegments);
+    }
+    return entireDifferencePath;
+}
+
 @end
@@ -13,4 +13,21 @@
 
 -(void) setMayCrossBoundary:(BOOL)mayCrossBoundary;
 
+/**
+ * gives each intersection in the array integer ids so that
+ * later comparisons between them don't need to look at
+ * their t values:
+ *
+ * - intersections that are isEqualToIntersection: share an id,
+ *   and their flipped copies share it too
+ * - intersections at the same location along a path share a
+ *   location id for that path, including the end of one element
+ *   and the start of the next
+ *
+ * ids are only comparable between intersections from the same
+ * call, or their flipped copies. all other comparisons
+ * fall back to comparing element indexes and t values.
+ */
++(void) assignIdsToIntersections:(NSArray*)intersections;
+
 @end
@@ -11,6 +11,89 @@
 #import "DKUIBezierPathIntersectionPoint+Private.h"
 #import <PerformanceBezier/PerformanceBezier.h>
 
+// t values are compared after rounding them to 6 decimal places
+#define kIntersectionTValueRounding 1000000.0
+
+// each call to +assignIdsToIntersections: is its own table of
+// ids, so that ids from different calls are never compared
+static NSUInteger intersectionTableIdGeneration = 0;
+
+/**
+ * the values that isEqualToIntersection: compares,
+ * and the index of the intersection they came from
+ */
+typedef struct {
+    NSInteger elementIndex1;
+    long long roundedTValue1;
+    NSInteger elementIndex2;
+    long long roundedTValue2;
+    NSUInteger index;
+} DKIntersectionKey;
+
+/**
+ * a location along one of the two paths, and the
+ * index of the intersection it came from
+ */
+typedef struct {
+    NSInteger path;
+    NSInteger elementIndex;
+    CGFloat tValue;
+    NSUInteger index;
+} DKIntersectionLocationKey;
+
+static int compareIntersectionKeys(const void* a, const void* b){
+    const DKIntersectionKey* key1 = a;
+    const DKIntersectionKey* key2 = b;
+    if(key1->elementIndex1 != key2->elementIndex1){
+        return key1->elementIndex1 < key2->elementIndex1 ? -1 : 1;
+    }
+    if(key1->roundedTValue1 != key2->roundedTValue1){
+        return key1->roundedTValue1 < key2->roundedTValue1 ? -1 : 1;
+    }
+    if(key1->elementIndex2 != key2->elementIndex2){
+        return key1->elementIndex2 < key2->elementIndex2 ? -1 : 1;
+    }
+    if(key1->roundedTValue2 != key2->roundedTValue2){
+        return key1->roundedTValue2 < key2->roundedTValue2 ? -1 : 1;
+    }
+    return 0;
+}
+
+static int compareLocationKeys(const void* a, const void* b){
+    const DKIntersectionLocationKey* key1 = a;
+    const DKIntersectionLocationKey* key2 = b;
+    if(key1->path != key2->path){
+        return key1->path < key2->path ? -1 : 1;
+    }
+    if(key1->elementIndex != key2->elementIndex){
+        return key1->elementIndex < key2->elementIndex ? -1 : 1;
+    }
+    if(key1->tValue != key2->tValue){
+        return key1->tValue < key2->tValue ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * the end of an element is the same location as the start of the
+ * next, so those are moved to the start of the next element. this
+ * is the same matching that matchesElementEndpointWithIntersection:
+ * does, including the end of the last element matching the start
+ * of element 1, just after the moveTo.
+ */
+static DKIntersectionLocationKey locationKey(NSInteger path, NSInteger elementIndex, CGFloat tValue, NSInteger elementCount, NSUInteger index){
+    if(tValue == 1){
+        elementIndex = (elementIndex == elementCount - 1) ? 1 : elementIndex + 1;
+        tValue = 0;
+    }
+    DKIntersectionLocationKey key;
+    key.path = path;
+    key.elementIndex = elementIndex;
+    key.tValue = tValue;
+    key.index = index;
+    return key;
+}
+
 @implementation DKUIBezierPathIntersectionPoint{
     NSInteger elementIndex1;
     CGFloat tValue1;
@@ -25,6 +108,15 @@
     CGFloat lenAtInter2;
     CGFloat pathLength1;
     CGFloat pathLength2;
+    // set by +assignIdsToIntersections:, and 0
+    // if we don't have any ids
+    NSUInteger tableId;
+    NSInteger intersectionId;
+    NSInteger locationId1;
+    NSInteger locationId2;
+    // YES if our element index 1 and 2 are swapped
+    // from when the ids were assigned
+    BOOL isFlipped;
 }
 
 @synthesize elementIndex1;
@@ -97,9 +189,84 @@
     ret.mayCrossBoundary = self.mayCrossBoundary;
     ret.pathLength1 = self.pathLength2;
     ret.pathLength2 = self.pathLength1;
+    ret->tableId = tableId;
+    ret->intersectionId = intersectionId;
+    ret->locationId1 = locationId2;
+    ret->locationId2 = locationId1;
+    ret->isFlipped = !isFlipped;
     return ret;
 }
 
++(void) assignIdsToIntersections:(NSArray*)intersections{
+    NSUInteger count = [intersections count];
+    if(!count){
+        return;
+    }
+    NSUInteger newTableId;
+    @synchronized([DKUIBezierPathIntersectionPoint class]){
+        intersectionTableIdGeneration++;
+        newTableId = intersectionTableIdGeneration;
+    }
+    
+    DKIntersectionKey* keys = malloc(sizeof(DKIntersectionKey) * count);
+    DKIntersectionLocationKey* locations = malloc(sizeof(DKIntersectionLocationKey) * count * 2);
+    if(!keys || !locations){
+        free(keys);
+        free(locations);
+        @throw [NSException exceptionWithName:@"Memory Exception" reason:@"can't malloc" userInfo:nil];
+    }
+    
+    NSUInteger keyCount = 0;
+    for(NSUInteger i=0;i<count;i++){
+        DKUIBezierPathIntersectionPoint* inter = [intersections objectAtIndex:i];
+        inter->tableId = 0;
+        if(!isfinite(inter.tValue1) || !isfinite(inter.tValue2)){
+            // these never equal anything, not even themselves,
+            // so leave them to the slow comparisons
+            continue;
+        }
+        keys[keyCount].elementIndex1 = inter.elementIndex1;
+        keys[keyCount].roundedTValue1 = llround(inter.tValue1 * kIntersectionTValueRounding);
+        keys[keyCount].elementIndex2 = inter.elementIndex2;
+        keys[keyCount].roundedTValue2 = llround(inter.tValue2 * kIntersectionTValueRounding);
+        keys[keyCount].index = i;
+        locations[keyCount * 2] = locationKey(1, inter.elementIndex1, inter.tValue1, inter.elementCount1, i);
+        locations[keyCount * 2 + 1] = locationKey(2, inter.elementIndex2, inter.tValue2, inter.elementCount2, i);
+        keyCount++;
+    }
+    
+    // sorting puts equal keys next to each other, so each
+    // run of equal keys gets the next id
+    qsort(keys, keyCount, sizeof(DKIntersectionKey), compareIntersectionKeys);
+    NSInteger nextId = 0;
+    for(NSUInteger i=0;i<keyCount;i++){
+        if(i == 0 || compareIntersectionKeys(&keys[i - 1], &keys[i]) != 0){
+            nextId++;
+        }
+        DKUIBezierPathIntersectionPoint* inter = [intersections objectAtIndex:keys[i].index];
+        inter->tableId = newTableId;
+        inter->intersectionId = nextId;
+        inter->isFlipped = NO;
+    }
+    
+    qsort(locations, keyCount * 2, sizeof(DKIntersectionLocationKey), compareLocationKeys);
+    nextId = 0;
+    for(NSUInteger i=0;i<keyCount * 2;i++){
+        if(i == 0 || compareLocationKeys(&locations[i - 1], &locations[i]) != 0){
+            nextId++;
+        }
+        DKUIBezierPathIntersectionPoint* inter = [intersections objectAtIndex:locations[i].index];
+        if(locations[i].path == 1){
+            inter->locationId1 = nextId;
+        }else{
+            inter->locationId2 = nextId;
+        }
+    }
+    
+    free(keys);
+    free(locations);
+}
+
 /**
  * returns YES if the two intersections are close.
  * this is the case if the two locations are within
@@ -148,6 +315,9 @@
 // element 4, tvalue 0, and the other element 3
 // tvalue 1
 -(BOOL) matchesElementEndpointWithIntersection:(DKUIBezierPathIntersectionPoint*)obj{
+    if(tableId && obj && obj->tableId == tableId && obj->isFlipped == isFlipped){
+        return locationId1 == obj->locationId1 || locationId2 == obj->locationId2;
+    }
     BOOL ret = NO;
     if(self.elementIndex1 == elementCount1 - 1 && [obj elementIndex1] == 1 &&
        self.tValue1 == 1 && [obj tValue1] == 0){
@@ -200,6 +370,10 @@
 }
 
 -(BOOL) crossMatchesIntersection:(DKUIBezierPathIntersectionPoint *)otherInter{
+    if(tableId && otherInter && otherInter->tableId == tableId && otherInter->isFlipped != isFlipped){
+        // our path 1 is the other's path 2, and vice versa
+        return locationId1 == otherInter->locationId2 || locationId2 == otherInter->locationId1;
+    }
     BOOL ret = NO;
     if(self.elementIndex1 == elementCount1 - 1 && [otherInter elementIndex2] == 1 &&
        self.tValue1 == 1 && [otherInter tValue2] == 0){
@@ -248,6 +422,9 @@
 -(BOOL) isEqualToIntersection:(id)object{
     if([object isKindOfClass:[DKUIBezierPathIntersectionPoint class]]){
         DKUIBezierPathIntersectionPoint* other = (DKUIBezierPathIntersectionPoint*)object;
+        if(tableId && other->tableId == tableId && other->isFlipped == isFlipped){
+            return intersectionId == other->intersectionId;
+        }
         if(self.elementIndex1 == other.elementIndex1 &&
            [self roundedTValue:self.tValue1] == [self roundedTValue:other.tValue1] &&
            self.elementIndex2 == other.elementIndex2 &&
@@ -265,21 +442,30 @@
     return [super isEqual:object];
 }
 
+static NSUInteger hashOfRoundedTValue(CGFloat tVal){
+    // non-finite t values never equal anything, so
+    // any hash will do, but they can't be rounded
+    return isfinite(tVal) ? (NSUInteger)llround(tVal * kIntersectionTValueRounding) : 0;
+}
+
+/**
+ * hashes exactly what isEqualToIntersection: compares, the element
+ * indexes and the t values rounded the same way, so intersections
+ * that are equal always hash the same
+ */
 -(NSUInteger) hash{
     NSUInteger prime = 31;
     NSUInteger result = 1;
     result = prime * result + self.elementIndex1;
-    result = prime * result + self.elementCount1;
-    result = prime * result + self.tValue1;
+    result = prime * result + hashOfRoundedTValue(self.tValue1);
     result = prime * result + self.elementIndex2;
-    result = prime * result + self.elementCount2;
-    result = prime * result + self.tValue2;
-    result = prime * result + ((self.mayCrossBoundary)?1231:1237);
+    result = prime * result + hashOfRoundedTValue(self.tValue2);
     return result;
 }
 
+
 -(CGFloat) roundedTValue:(CGFloat)tVal{
-    return (CGFloat) round(tVal * pow(10, 6)) / pow(10,6);
+    return (CGFloat) round(tVal * kIntersectionTValueRounding) / kIntersectionTValueRounding;
 }
 
 
@@ -26,4 +26,13 @@
 
 -(BOOL) sharesSegmentWith:(DKUIBezierPathShape*)otherShape;
 
+// the area of the fullPath, found from the segments' curves
+// without building it. the area is positive when the shell runs
+// clockwise on screen, and holes always take away from it
+-(CGFloat) signedArea;
+
+// the center of mass of the fullPath, with its holes cut out.
+// a shape with no area has its centroid at CGPointZero
+-(CGPoint) centroid;
+
 @end
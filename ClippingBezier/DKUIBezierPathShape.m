@@ -121,5 +121,55 @@
     return NO;
 }
 
+#pragma mark - Area
+
+/**
+ * the area integrals around the outside of the shape, and then
+ * around each hole in the opposite direction, the same as fullPath.
+ * straight lines fill in any gap between the end of one segment
+ * and the start of the next, and close the shape
+ */
+-(DKAreaMoments) areaMoments{
+    DKAreaMoments moments = { 0, 0, 0, CGPointZero, CGPointZero };
+    if(![segments count]){
+        return moments;
+    }
+    DKAreaMoments firstMoments = [[segments firstObject] areaMoments];
+    CGPoint lastPoint = firstMoments.startPoint;
+    for(DKUIBezierPathClippedSegment* seg in segments){
+        DKAreaMoments segMoments = [seg areaMoments];
+        DKAddAreaMomentsOfLine(&moments, lastPoint, segMoments.startPoint);
+        moments.area += segMoments.area;
+        moments.momentX += segMoments.momentX;
+        moments.momentY += segMoments.momentY;
+        lastPoint = segMoments.endPoint;
+    }
+    DKAddAreaMomentsOfLine(&moments, lastPoint, firstMoments.startPoint);
+    moments.startPoint = firstMoments.startPoint;
+    moments.endPoint = firstMoments.startPoint;
+
+    BOOL selfIsPositive = moments.area > 0;
+    for(DKUIBezierPathShape* hole in holes){
+        DKAreaMoments holeMoments = [hole areaMoments];
+        CGFloat direction = ((holeMoments.area > 0) == selfIsPositive) ? -1 : 1;
+        moments.area += direction * holeMoments.area;
+        moments.momentX += direction * holeMoments.momentX;
+        moments.momentY += direction * holeMoments.momentY;
+    }
+    return moments;
+}
+
+-(CGFloat) signedArea{
+    return [self areaMoments].area;
+}
+
+-(CGPoint) centroid{
+    DKAreaMoments moments = [self areaMoments];
+    if(moments.area == 0){
+        return CGPointZero;
+    }
+    return CGPointMake(moments.momentX / moments.area, moments.momentY / moments.area);
+}
+
 
 @end
@@ -0,0 +1,106 @@
+//
+//  DKVectorValue.h
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#ifndef DKVectorValue_h
+#define DKVectorValue_h
+
+#import <CoreGraphics/CoreGraphics.h>
+#include <math.h>
+
+/**
+ * a plain value version of DKVector, for code that compares
+ * enough tangents that allocating a DKVector for each one
+ * shows up. each method does the same math as the DKVector
+ * method of the same name, float precision included, so
+ * their results are interchangeable.
+ */
+struct DKVectorValue {
+    CGFloat x;
+    CGFloat y;
+
+    DKVectorValue() : x(0), y(0) {}
+
+    DKVectorValue(CGFloat _x, CGFloat _y) : x(_x), y(_y) {}
+
+    DKVectorValue(CGPoint p1, CGPoint p2) : x(p2.x - p1.x), y(p2.y - p1.y) {}
+
+    static DKVectorValue withAngle(CGFloat angle){
+        return DKVectorValue(cosf(angle), sinf(angle));
+    }
+
+    CGFloat angle() const {
+        CGFloat theta = atanf(y / x);
+        // adjust the angle depending on which quadrant it's in
+        if(y < 0 && x < 0){
+            theta -= M_PI;
+        }else if(!(y < 0) && x < 0){
+            theta += M_PI;
+        }
+        return theta;
+    }
+
+    DKVectorValue normal() const {
+        CGFloat length = sqrt(x * x + y * y);
+        return DKVectorValue(x / length, y / length);
+    }
+
+    DKVectorValue perpendicular() const {
+        return DKVectorValue(-y, x);
+    }
+
+    DKVectorValue flip() const {
+        return DKVectorValue(-x, -y);
+    }
+
+    CGFloat magnitude() const {
+        return sqrtf(x * x + y * y);
+    }
+
+    CGPoint pointFromPoint(CGPoint point, CGFloat distance) const {
+        return CGPointMake(point.x + x * distance, point.y + y * distance);
+    }
+
+    DKVectorValue averageWith(const DKVectorValue& vector) const {
+        return DKVectorValue((x + vector.x) / 2, (y + vector.y) / 2);
+    }
+
+    DKVectorValue rotateBy(CGFloat angle) const {
+        return DKVectorValue(x * cosf(angle) - y * sinf(angle),
+                             x * sinf(angle) + y * cosf(angle));
+    }
+
+    DKVectorValue mirrorAround(const DKVectorValue& normal) const {
+        CGFloat dotprod = -x * normal.x - y * normal.y;
+        return DKVectorValue(x + 2 * normal.x * dotprod,
+                             y + 2 * normal.y * dotprod);
+    }
+
+    /**
+     * the angle from other to self, in the range (−π, π]
+     */
+    CGFloat angleBetween(const DKVectorValue& other) const {
+        float thetaA = atan2(other.x, other.y);
+        float thetaB = atan2(x, y);
+
+        float thetaAB = thetaB - thetaA;
+
+        while (thetaAB <= - M_PI)
+            thetaAB += 2 * M_PI;
+
+        while (thetaAB > M_PI)
+            thetaAB -= 2 * M_PI;
+
+        return thetaAB;
+    }
+
+    CGPoint asCGPoint() const {
+        return CGPointMake(x, y);
+    }
+};
+
+#endif /* DKVectorValue_h */
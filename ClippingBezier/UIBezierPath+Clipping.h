@@ -11,6 +11,18 @@
 #import "DKUIBezierPathIntersectionPoint.h"
 #import "DKTangentAtPoint.h"
 #import "DKUIBezierPathClippedSegment.h"
+#import "DKUIBezierPathClippingOptions.h"
+#import "DKUIBezierPathClippingOperation.h"
+
+/**
+ * how precise a time budgeted clipping result is
+ */
+typedef NS_ENUM(NSInteger, DKUIBezierPathClippingTier) {
+    // found from flattened copies of the paths
+    DKUIBezierPathClippingTierCoarse,
+    // found from the paths themselves
+    DKUIBezierPathClippingTierFull
+};
 
 @interface UIBezierPath (MMClipping)
 
@@ -20,6 +32,14 @@
 
 +(NSArray*) redAndGreenAndBlueSegmentsCreatedFrom:(UIBezierPath*)shapePath bySlicingWithPath:(UIBezierPath*)scissorPath andNumberOfBlueShellSegments:(NSUInteger*)numberOfBlueShellSegments;
 
+// the blue segments reuse the intersections found for the red and green
+// segments instead of finding them again. when this is set, they're
+// found again anyways and checked against the reused ones, which throws
+// if the two disagree. this is slow, and only meant for debugging
++(void) setValidatesDerivedIntersections:(BOOL)validates;
+
++(BOOL) validatesDerivedIntersections;
+
 +(DKUIBezierPathClippedSegment*) getBestMatchSegmentForSegments:(NSArray*)shapeSegments
                                                          forRed:(NSArray*)redSegments
                                                         andBlue:(NSArray*)blueSegments
@@ -32,8 +52,162 @@
 
 -(UIBezierPath*) differenceOfPathTo:(UIBezierPath*)shapePath;
 
+#pragma mark - Clipping Options
+
+/**
+ * same as uniqueShapesCreatedFromSlicingWithUnclosedPath:, but
+ * both paths are first simplified if the options ask for it. the
+ * returned shapes are built from the simplified paths.
+ */
+-(NSArray*) uniqueShapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath withOptions:(DKUIBezierPathClippingOptions*)options;
+
+/**
+ * clips self to the input closed path, and returns both the
+ * intersection and difference. both paths are first simplified
+ * if the options ask for it, and the result's segments are
+ * built from those simplified paths.
+ */
+-(DKUIBezierPathClippingResult*) clipToClosedPath:(UIBezierPath*)closedPath withOptions:(DKUIBezierPathClippingOptions*)options;
+
+/**
+ * the same as uniqueShapesCreatedFromSlicingWithUnclosedPath:withOptions:,
+ * but also returns how the element indexes in the shapes' intersections
+ * and segments map back to each of the original paths. the mappings are
+ * the same as bezierPathBySimplifyingWithTolerance:andCornerAngle:elementMapping:
+ * returns, and each element maps to itself if the options don't simplify.
+ * either mapping can be nil if it isn't needed.
+ */
+-(NSArray*) uniqueShapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath
+                                               withOptions:(DKUIBezierPathClippingOptions*)options
+                                       shapeElementMapping:(NSArray**)shapeElementMapping
+                                  andScissorElementMapping:(NSArray**)scissorElementMapping;
+
+/**
+ * the same as clipToClosedPath:withOptions:, with element
+ * mappings for self and the closedPath like the method above
+ */
+-(DKUIBezierPathClippingResult*) clipToClosedPath:(UIBezierPath*)closedPath
+                                      withOptions:(DKUIBezierPathClippingOptions*)options
+                                   elementMapping:(NSArray**)elementMapping
+                      andClosedPathElementMapping:(NSArray**)closedPathElementMapping;
+
+#pragma mark - Rectangle Clipping
+
+/**
+ * the same as clipToClosedPath:withOptions: with a path of the
+ * rect and the default options, but much faster. each element is
+ * solved against the edges of the rect directly, instead of with
+ * the bezier clipping used for arbitrary paths.
+ *
+ * the segments' intersections refer to the rect as a path that moves
+ * to the top left corner, and then runs along the top, right, bottom
+ * and left edges, in that order.
+ */
+-(DKUIBezierPathClippingResult*) clipToRect:(CGRect)rect;
+
+#pragma mark - Path Distance
+
+/**
+ * the shortest distance between any point on self and any point on
+ * the other path, to within kUIBezierDistancePrecision, 0.01 points.
+ * the closest point on each path is returned as its element index and
+ * the t value along that element, and any of those can be nil if they
+ * aren't needed.
+ *
+ * the lines that close subpaths count, but a lone move to doesn't. if
+ * either path has no lines or curves, this returns CGFLOAT_MAX and
+ * the element indexes are -1.
+ */
+-(CGFloat) closestDistanceToPath:(UIBezierPath*)otherPath
+                         atIndex:(NSInteger*)elementIndex
+                andElementTValue:(CGFloat*)tValue
+                      otherIndex:(NSInteger*)otherElementIndex
+           andOtherElementTValue:(CGFloat*)otherTValue;
+
+/**
+ * YES if the two paths come within radius of each other. this stops
+ * as soon as it finds any pair of points that close, and never looks
+ * at parts of the paths that are farther apart than radius, so it's
+ * much faster than closestDistanceToPath: for near miss checks.
+ *
+ * the search stops refining once it's within kUIBezierDistancePrecision,
+ * 0.01 points, so this can return YES for paths that are as much as
+ * radius + kUIBezierDistancePrecision apart. it never returns NO for
+ * paths that are within radius.
+ */
+-(BOOL) isWithinDistance:(CGFloat)radius ofPath:(UIBezierPath*)otherPath;
+
+#pragma mark - Time Budgeted Clipping
+
+/**
+ * the same as uniqueShapesCreatedFromSlicingWithUnclosedPath:withOptions:,
+ * but it tries to finish by the deadline, which is compared to
+ * CFAbsoluteTimeGetCurrent(). it always finds a coarse result from
+ * copies of the paths with their curves flattened to lines within
+ * half a point, and then only returns the full precision result if
+ * that finishes before the deadline. the tier, if given, is set to
+ * whichever of the two was returned.
+ *
+ * the deadline is not a hard budget. the coarse result is always
+ * found in full, however long it takes, and the full result is only
+ * started if there's time left after it. very complex paths can
+ * still run past the deadline while finding the coarse result.
+ */
+-(NSArray*) uniqueShapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath
+                                               withOptions:(DKUIBezierPathClippingOptions*)options
+                                                  deadline:(CFAbsoluteTime)deadline
+                                                      tier:(DKUIBezierPathClippingTier*)tier;
+
+/**
+ * the same as clipToClosedPath:withOptions:, but with a
+ * deadline and tiers that work the same as the method above
+ */
+-(DKUIBezierPathClippingResult*) clipToClosedPath:(UIBezierPath*)closedPath
+                                      withOptions:(DKUIBezierPathClippingOptions*)options
+                                         deadline:(CFAbsoluteTime)deadline
+                                             tier:(DKUIBezierPathClippingTier*)tier;
+
+#pragma mark - Asynchronous Clipping
+
+/**
+ * the same as uniqueShapesCreatedFromSlicingWithUnclosedPath:withOptions:,
+ * but run on a background queue. the paths are copied before this
+ * returns. the completion is called on the main queue, unless the
+ * returned operation is cancelled first, in which case the work stops
+ * soon after and the completion is never called. any other exception
+ * thrown while clipping is not caught, the same as it wouldn't be
+ * for the synchronous method.
+ */
+-(DKUIBezierPathClippingOperation*) uniqueShapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath
+                                                                      withOptions:(DKUIBezierPathClippingOptions*)options
+                                                                       completion:(void (^)(NSArray* shapes))completion;
+
+/**
+ * the same as clipToClosedPath:withOptions:, but run on a background
+ * queue, and cancelled the same way as the method above
+ */
+-(DKUIBezierPathClippingOperation*) clipToClosedPath:(UIBezierPath*)closedPath
+                                         withOptions:(DKUIBezierPathClippingOptions*)options
+                                          completion:(void (^)(DKUIBezierPathClippingResult* result))completion;
+
+#pragma mark - Intersection Cache
+
+// when the capacity is more than 0, the intersections found between
+// each pair of curves are remembered, and found again from the cache
+// the next time the exact same pair is compared. only the most
+// recently used pairs are kept. the cache is shared by all threads,
+// and defaults to a capacity of 0, which turns it off
+
++(void) setIntersectionCacheCapacity:(NSUInteger)capacity;
+
++(NSUInteger) intersectionCacheCapacity;
+
++(void) clearIntersectionCache;
+
 #pragma mark - Segment Comparison
 
+// these counts are kept separately for each thread
+
 +(void) resetSegmentTestCount;
 
 +(NSInteger) segmentTestCount;
@@ -42,5 +216,25 @@
 
 +(NSInteger) segmentCompareCount;
 
++(void) resetSegmentHullRejectCount;
+
++(NSInteger) segmentHullRejectCount;
+
++(void) resetSegmentOverlapCount;
+
++(NSInteger) segmentOverlapCount;
+
++(void) resetSegmentCacheHitCount;
+
++(NSInteger) segmentCacheHitCount;
+
++(void) resetSegmentCacheMissCount;
+
++(NSInteger) segmentCacheMissCount;
+
++(void) resetSegmentSplitCount;
+
++(NSInteger) segmentSplitCount;
+
 
 @end
@@ -17,9 +17,12 @@
 #import "UIBezierPath+Clipping.h"
 #include "interval.h"
 #include <vector>
+#include <memory>
+#include <atomic>
 #import "DKUIBezierPathClippingResult.h"
 #import "DKUIBezierPathIntersectionPoint.h"
 #import "DKUIBezierPathClippedSegment.h"
+#import "DKUIBezierPathClippedSegment+Private.h"
 #import "DKUIBezierPathIntersectionPoint+Private.h"
 #import "DKUIBezierUnmatchedPathIntersectionPoint.h"
 #include "bezierclip.hxx"
@@ -27,6 +30,9 @@
 #import "UIBezierPath+Intersections.h"
 #import "UIBezierPath+Trimming.h"
 #import "UIBezierPath+Ahmed.h"
+#import "UIBezierPath+Simplification.h"
+#import "DKPathElementTable.h"
+#import "DKIntersectionCache.h"
 #import <PerformanceBezier/PerformanceBezier.h>
 #import <ClippingBezier/ClippingBezier.h>
 #include "point.h"
@@ -35,19 +41,208 @@
 
 #define kUIBezierClippingPrecision 0.0005
 #define kUIBezierClosenessPrecision 0.5
+// elements closer than this along a stretch of both
+// are treated as running along the same edge
+#define kUIBezierOverlapPrecision 0.01
+// the closest points found between two paths are
+// within this of the true closest distance
+#define kUIBezierDistancePrecision 0.01
+// the coarse tier of time budgeted clipping flattens
+// curves to lines that stray at most this far from them
+#define kUIBezierCoarseFlatness 0.5
+
+// the operation that clipping on this thread is running for,
+// if any. the block running the work keeps the operation alive
+// for as long as this is set
+static thread_local __unsafe_unretained DKUIBezierPathClippingOperation* currentClippingOperation = nil;
+// the time that clipping on this thread needs to
+// give up at, or 0 if there isn't one
+static thread_local CFAbsoluteTime currentClippingDeadline = 0;
+
+static BOOL clippingIsCancelled(){
+    return (currentClippingOperation && currentClippingOperation.isCancelled) ||
+    (currentClippingDeadline && CFAbsoluteTimeGetCurrent() > currentClippingDeadline);
+}
+
+/**
+ * unwinds the clipping work if its operation has been cancelled,
+ * or if its deadline has passed.
+ * this is only called from our own loops, and never from inside
+ * an iteratePathWithBlock: block, so the exception doesn't have
+ * to unwind through CGPathApply
+ */
+static void throwIfClippingCancelled(){
+    if(clippingIsCancelled()){
+        @throw [NSException exceptionWithName:DKUIBezierPathClippingCancelledException reason:@"clipping operation was cancelled" userInfo:nil];
+    }
+}
+
+/**
+ * an element of a path, measured as if it were a
+ * straight line from its start to its end point
+ */
+struct DKTangentElement {
+    CGPathElementType type;
+    CGPoint startPoint;
+    CGPoint points[3];
+    CGFloat length;
+};
+
+/**
+ * fills elements with every element of the path, and returns
+ * their total length. each element is treated as a line, so it's
+ * very far from perfect, but good enough to pick out the element
+ * for a tangent near either end of the path.
+ */
+static CGFloat measureElementsForTangents(UIBezierPath* path, std::vector<DKTangentElement>* elements){
+    __block CGFloat entireLength = 0;
+    __block CGPoint lastPoint = CGPointNotFound;
+    CGPoint firstPoint = path.firstPoint;
+    elements->reserve([path elementCount]);
+    [path iteratePathWithBlock:^(CGPathElement element, NSUInteger idx){
+        CGPoint nextLastPoint = lastPoint;
+        if(element.type == kCGPathElementAddLineToPoint){
+            nextLastPoint = element.points[0];
+        }else if(element.type == kCGPathElementAddQuadCurveToPoint){
+            nextLastPoint = element.points[1];
+        }else if(element.type == kCGPathElementAddCurveToPoint){
+            nextLastPoint = element.points[2];
+        }else if(element.type == kCGPathElementMoveToPoint){
+            nextLastPoint = element.points[0];
+        }else if(element.type == kCGPathElementCloseSubpath){
+            nextLastPoint = firstPoint;
+        }
+        
+        DKTangentElement entry;
+        entry.type = element.type;
+        entry.length = 0;
+        if(CGPointEqualToPoint(lastPoint, CGPointNotFound) || element.type == kCGPathElementMoveToPoint){
+            lastPoint = element.points[0];
+            nextLastPoint = lastPoint;
+        }else if(element.type != kCGPathElementCloseSubpath){
+            entry.length = distance(lastPoint, nextLastPoint);
+        }
+        entry.startPoint = lastPoint;
+        if(element.type == kCGPathElementAddCurveToPoint){
+            entry.points[0] = element.points[0];
+            entry.points[1] = element.points[1];
+            entry.points[2] = element.points[2];
+        }else if(element.type == kCGPathElementAddQuadCurveToPoint){
+            entry.points[0] = element.points[0];
+            entry.points[1] = element.points[1];
+        }else if(element.type == kCGPathElementCloseSubpath){
+            entry.points[0] = lastPoint;
+        }else{
+            entry.points[0] = element.points[0];
+        }
+        elements->push_back(entry);
+        entireLength += entry.length;
+        
+        lastPoint = nextLastPoint;
+    }];
+    return entireLength;
+}
+
+/**
+ * finds the tangent and point near tValue of the measured elements, but
+ * never more than maxDistForEndPointTangents away from the nearest end.
+ * returns NO if the path has no length to find a tangent along.
+ */
+static BOOL tangentNearStartOrEndOfElements(const std::vector<DKTangentElement>& elements, CGFloat entireLength, CGFloat tValue, CGPoint* tangent, CGPoint* point){
+    const int maxDist = [UIBezierPath maxDistForEndPointTangents];
+    CGFloat lengthAtT = entireLength * tValue;
+    if(tValue > .5){
+        if(lengthAtT < entireLength - maxDist){
+            lengthAtT = entireLength - maxDist;
+            tValue = lengthAtT / entireLength;
+        }
+    }else{
+        if(lengthAtT > maxDist){
+            lengthAtT = maxDist;
+            tValue = lengthAtT / entireLength;
+        }
+    }
+    
+    CGFloat lengthSoFar = 0;
+    for(size_t i=0;i<elements.size();i++){
+        const DKTangentElement& element = elements[i];
+        if(lengthSoFar + element.length > lengthAtT){
+            // this is the element to use for our calculation
+            // scale the tvalue to this element
+            
+            // chop the front of the path off
+            CGFloat tSoFar = lengthSoFar / entireLength;
+            CGFloat tValueToUse = tValue - tSoFar;
+            
+            // chop off the end of the path
+            CGFloat tDurationOfElement = (element.length) / entireLength;
+            if(tDurationOfElement){
+                tValueToUse /= tDurationOfElement;
+            }
+            
+            // use this tvalue
+            CGPoint bez[4];
+            bez[0] = element.startPoint;
+            bez[3] = element.points[0];
+            if(element.type == kCGPathElementAddLineToPoint){
+                CGFloat width = element.points[0].x - element.startPoint.x;
+                CGFloat height = element.points[0].y - element.startPoint.y;
+                bez[1] = CGPointMake(element.startPoint.x + width/3.0, element.startPoint.y + height/3.0);
+                bez[2] = CGPointMake(element.startPoint.x + width/3.0*2.0, element.startPoint.y + height/3.0*2.0);
+            }else if(element.type == kCGPathElementAddQuadCurveToPoint){
+                bez[1] = element.points[0];
+                bez[2] = element.points[0];
+                bez[3] = element.points[1];
+            }else if(element.type == kCGPathElementAddCurveToPoint){
+                bez[1] = element.points[0];
+                bez[2] = element.points[1];
+                bez[3] = element.points[2];
+            }else{
+                bez[1] = bez[0];
+                bez[2] = bez[0];
+            }
+            
+            *tangent = [UIBezierPath tangentAtT:tValueToUse forBezier:bez];
+            *point = [UIBezierPath pointAtT:tValueToUse forBezier:bez];
+            return YES;
+        }
+        lengthSoFar += element.length;
+    }
+    return NO;
+}
+
 
 @implementation UIBezierPath (Clipping)
 
 #pragma mark - Segment Comparison
 
+// all of these counts are kept per thread, so that
+// asynchronous clipping doesn't change them
+// while the calling thread reads them
+
 // segment test count is the product
 // of the two path's element count
-static NSInteger segmentTestCount = 0;
+static thread_local NSInteger segmentTestCount = 0;
 // segment compare count is the number
 // of segments that are actually tested
 // for intersections, and is a subset
 // of segmentTestCount
-static NSInteger segmentCompareCount = 0;
+static thread_local NSInteger segmentCompareCount = 0;
+// segment hull reject count is the number
+// of segments whose bounds overlap, but whose
+// control point hulls don't, so they're never
+// compared. these aren't in segmentCompareCount
+static thread_local NSInteger segmentHullRejectCount = 0;
+// segment overlap count is the number of compared
+// segments that run along each other, and that only
+// report the two ends of that overlap
+static thread_local NSInteger segmentOverlapCount = 0;
+// segment cache hit and miss counts are the number of
+// curve pairs whose intersections were or weren't found
+// in the intersection cache. both stay 0 while the
+// cache is turned off
+static thread_local NSInteger segmentCacheHitCount = 0;
+static thread_local NSInteger segmentCacheMissCount = 0;
 
 +(void) resetSegmentTestCount{
     segmentTestCount = 0;
@@ -65,6 +260,64 @@ static NSInteger segmentCompareCount = 0;
     return segmentCompareCount;
 }
 
++(void) resetSegmentHullRejectCount{
+    segmentHullRejectCount = 0;
+}
+
++(NSInteger) segmentHullRejectCount{
+    return segmentHullRejectCount;
+}
+
++(void) resetSegmentOverlapCount{
+    segmentOverlapCount = 0;
+}
+
++(NSInteger) segmentOverlapCount{
+    return segmentOverlapCount;
+}
+
++(void) resetSegmentCacheHitCount{
+    segmentCacheHitCount = 0;
+}
+
++(NSInteger) segmentCacheHitCount{
+    return segmentCacheHitCount;
+}
+
++(void) resetSegmentCacheMissCount{
+    segmentCacheMissCount = 0;
+}
+
++(NSInteger) segmentCacheMissCount{
+    return segmentCacheMissCount;
+}
+
+// the number of times that the bezier clipping had
+// to split a curve in half because clipping it against
+// the other curve didn't shrink it enough
++(void) resetSegmentSplitCount{
+    Geom::reset_split_count();
+}
+
++(NSInteger) segmentSplitCount{
+    return (NSInteger)Geom::get_split_count();
+}
+
+
+#pragma mark - Intersection Cache
+
++(void) setIntersectionCacheCapacity:(NSUInteger)capacity{
+    DKIntersectionCache::shared().setCapacity(capacity);
+}
+
++(NSUInteger) intersectionCacheCapacity{
+    return DKIntersectionCache::shared().capacity();
+}
+
++(void) clearIntersectionCache{
+    DKIntersectionCache::shared().clear();
+}
+
 
 #pragma mark - Intersection Finding
 
@@ -74,6 +327,17 @@ static NSInteger segmentCompareCount = 0;
  * the self path and the input closed path.
  */
 -(NSArray*) findIntersectionsWithClosedPath:(UIBezierPath*)closedPath andBeginsInside:(BOOL*)beginsInside{
+    return [self findIntersectionsWithClosedPath:closedPath andBeginsInside:beginsInside withTable:NULL andClosedPathTable:NULL];
+}
+
+/**
+ * the same as above, but with element tables that were already
+ * built for self and the closed path at kUIBezierClippingPrecision.
+ * this lets callers that compare the same paths over and over
+ * build each table once. either table can be NULL, and it will
+ * be built here instead.
+ */
+-(NSArray*) findIntersectionsWithClosedPath:(UIBezierPath*)closedPath andBeginsInside:(BOOL*)beginsInside withTable:(const DKPathElementTable*)selfTable andClosedPathTable:(const DKPathElementTable*)closedPathTable{
     
     // hold our bezier information for the curves we compare
     CGPoint bez1_[4];
@@ -108,26 +372,35 @@ static NSInteger segmentCompareCount = 0;
     
     
     
-    // track if the path1Element begins inside or
-    // outside the closed path. this will help us track
-    // if intersection points actually change where the curve
-    // lands
-    __block CGPoint lastPath1Point = CGPointNotFound;
     // this array will hold all of the intersection data as we
     // find them
     NSMutableArray* foundIntersections = [NSMutableArray array];
-    
-    
-    __block CGPoint path1StartingPoint = path1.firstPoint;
+
+    // work out the bezier, bounds, and length of each element
+    // just once, instead of once for every pair of elements
+    std::unique_ptr<DKPathElementTable> selfTableStorage;
+    std::unique_ptr<DKPathElementTable> closedPathTableStorage;
+    if(!selfTable){
+        selfTableStorage.reset(new DKPathElementTable(self, kUIBezierClippingPrecision));
+        selfTable = selfTableStorage.get();
+    }
+    if(!closedPathTable){
+        closedPathTableStorage.reset(new DKPathElementTable(closedPath, kUIBezierClippingPrecision));
+        closedPathTable = closedPathTableStorage.get();
+    }
+    const DKPathElementTable& table1 = didFlipPathNumbers ? *closedPathTable : *selfTable;
+    const DKPathElementTable& table2 = didFlipPathNumbers ? *selfTable : *closedPathTable;
+
     // the lengths along the paths that we calculate are
     // estimates only, and not exact
     __block CGFloat path1EstimatedLength = 0;
-    __block CGFloat path2EstimatedLength = 0;
+    __block CGFloat path2EstimatedLength = table2.length();
 
     // first, confirm that the paths have a possibility of intersecting
-    // at all by comparing their bounds
-    CGRect path1Bounds = [path1 bounds];
-    CGRect path2Bounds = [path2 bounds];
+    // at all by comparing their bounds. these are the exact bounds
+    // of the curves, not the bounds of their control points
+    CGRect path1Bounds = table1.bounds();
+    CGRect path2Bounds = table2.bounds();
     // expand the bounds by 1px, just so we're sure to see overlapping bounds for tangent paths
     path1Bounds = CGRectInset(path1Bounds, -1, -1);
     path2Bounds = CGRectInset(path2Bounds, -1, -1);
@@ -143,130 +416,130 @@ static NSInteger segmentCompareCount = 0;
         // to find intersections, we'll loop over our path first,
         // and for each element inside us, we'll loop over the closed shape
         // to see if we've moved in/out of the closed shape
-        [path1 iteratePathWithBlock:^(CGPathElement path1Element, NSUInteger path1ElementIndex){
-            // must call this before fillCGPoints, since our call to fillCGPoints will update lastPath1Point
-            CGRect path1ElementBounds = [UIBezierPath boundsForElement:path1Element withStartPoint:lastPath1Point andSubPathStartingPoint:path1StartingPoint];
-            // expand the bounds by 1px, just so we're sure to see overlapping bounds for tangent paths
-            path1ElementBounds = CGRectInset(path1ElementBounds, -1, -1);
-            lastPath1Point = [UIBezierPath fillCGPoints:bez1
-                                            withElement:path1Element
-                              givenElementStartingPoint:lastPath1Point
-                                andSubPathStartingPoint:path1StartingPoint];
-            CGFloat path1EstimatedElementLength = 0;
-            
+        for(NSInteger path1ElementIndex = 0; path1ElementIndex < table1.count(); path1ElementIndex++){
+            throwIfClippingCancelled();
+            const DKPathElement& path1Element = table1[path1ElementIndex];
             // only look for intersections if it's not a moveto point.
             // this way our bez1 array will be filled with a valid
             // bezier curve
-            if(path1Element.type != kCGPathElementMoveToPoint){
-                path1EstimatedElementLength = [UIBezierPath estimateArcLengthOf:bez1 withSteps:10];
-                
-                __block CGPoint lastPath2Point = CGPointNotFound;
-                
-                if(CGRectIntersectsRect(path1ElementBounds, path2Bounds)){
-                    // at this point, we know that path1's element intersections somewhere within
-                    // all of path 2, so we'll iterate over path2 and find as many intersections
-                    // as we can
-                    __block CGPoint path2StartingPoint = path2.firstPoint;
-                    path2EstimatedLength = 0;
-                    // big iterating over path2 to find all intersections with this element from path1
-                    [path2 iteratePathWithBlock:^(CGPathElement path2Element, NSUInteger path2ElementIndex){
-                        // must call this before fillCGPoints, since that will update lastPath1Point
-                        CGRect path2ElementBounds = [UIBezierPath boundsForElement:path2Element withStartPoint:lastPath2Point andSubPathStartingPoint:path2StartingPoint];
-                        // expand the bounds by 1px, just so we're sure to see overlapping bounds for tangent paths
-                        path2ElementBounds = CGRectInset(path2ElementBounds, -1, -1);
-                        lastPath2Point = [UIBezierPath fillCGPoints:bez2
-                                                        withElement:path2Element
-                                          givenElementStartingPoint:lastPath2Point
-                                            andSubPathStartingPoint:path2StartingPoint];
-                        CGFloat path2ElementLength = 0;
-                        if(path2Element.type != kCGPathElementMoveToPoint){
-                            path2ElementLength = [UIBezierPath estimateArcLengthOf:bez2 withSteps:10];
-                            if(CGRectIntersectsRect(path1ElementBounds, path2ElementBounds)){
-                                // track the number of segment comparisons we have to do
-                                // this tracks our worst case of how many segment rects intersect
-                                segmentCompareCount++;
-                                
-                                // at this point, we have two valid bezier arrays populated
-                                // into bez1 and bez2. calculate if they intersect at all
-                                NSArray* intersections;
-                                if((path1Element.type == kCGPathElementAddLineToPoint || path1Element.type == kCGPathElementCloseSubpath) &&
-                                   (path2Element.type == kCGPathElementAddLineToPoint || path2Element.type == kCGPathElementCloseSubpath)){
-                                    // in this case, the two elements are both lines, so they can intersect at
-                                    // only 1 place.
-                                    // TODO: should i return two intersections if they're tangent?
-                                    CGPoint intersection = [UIBezierPath intersects2D:bez1[0] to:bez1[3] andLine:bez2[0] to:bez2[3]];
-                                    if(!CGPointEqualToPoint(intersection,CGPointNotFound)){
-                                        CGFloat path1TValue = distance(bez1[0], intersection) / distance(bez1[0], bez1[3]);
-                                        CGFloat path2TValue = distance(bez2[0], intersection) / distance(bez2[0], bez2[3]);
-                                        if(path1TValue >= 0 && path1TValue <= 1 &&
-                                           path2TValue >= 0 && path2TValue <= 1){
-                                            intersections = [NSArray arrayWithObject:[NSValue valueWithCGPoint:CGPointMake(path2TValue, path1TValue)]];
-                                        }else{
-                                            // doesn't intersect within allowed T values
-                                        }
-                                    }
+            if(path1Element.type == kCGPathElementMoveToPoint){
+                continue;
+            }
+            // expand the bounds by 1px, just so we're sure to see overlapping bounds for tangent paths
+            CGRect path1ElementBounds = CGRectInset(path1Element.bounds, -1, -1);
+            CGFloat path1EstimatedElementLength = path1Element.length;
+            memcpy(bez1, path1Element.bez, sizeof(bez1_));
+
+            if(CGRectIntersectsRect(path1ElementBounds, path2Bounds)){
+                // at this point, we know that path1's element intersections somewhere within
+                // all of path 2, so we'll iterate over path2 and find as many intersections
+                // as we can
+                CGFloat path2LengthBeforeElement = 0;
+                for(NSInteger path2ElementIndex = 0; path2ElementIndex < table2.count(); path2ElementIndex++){
+                    const DKPathElement& path2Element = table2[path2ElementIndex];
+                    if(path2Element.type == kCGPathElementMoveToPoint){
+                        continue;
+                    }
+                    CGFloat path2ElementLength = path2Element.length;
+                    // expand the bounds by 1px, just so we're sure to see overlapping bounds for tangent paths
+                    CGRect path2ElementBounds = CGRectInset(path2Element.bounds, -1, -1);
+                    if(CGRectIntersectsRect(path1ElementBounds, path2ElementBounds)){
+                        // each curve lies inside the hull of its control points, so if
+                        // the hulls are apart by more than the 1px on each side that we
+                        // gave the bounds, then the curves are too
+                        if(DKControlHullsAreSeparated(path1Element, path2Element, 2)){
+                            segmentHullRejectCount++;
+                            path2LengthBeforeElement += path2ElementLength;
+                            continue;
+                        }
+                        memcpy(bez2, path2Element.bez, sizeof(bez2_));
+                        // track the number of segment comparisons we have to do
+                        // this tracks our worst case of how many segment rects intersect
+                        segmentCompareCount++;
+
+                        // at this point, we have two valid bezier arrays populated
+                        // into bez1 and bez2. calculate if they intersect at all
+                        NSArray* intersections;
+                        DKElementOverlap overlap;
+                        if(!(path1Element.isLine() && path2Element.isLine()) &&
+                           DKOverlapOfElements(path1Element, path2Element, kUIBezierOverlapPrecision, &overlap)){
+                            // the elements run along each other, and the bezier clipping would
+                            // find a cluster of intersections all along that shared edge. the
+                            // segments only need its two ends, so that the edge is shared by
+                            // the segments on either side of it
+                            segmentOverlapCount++;
+                            intersections = [NSArray arrayWithObjects:[NSValue valueWithCGPoint:CGPointMake(overlap.tStart2, overlap.tStart1)],
+                                             [NSValue valueWithCGPoint:CGPointMake(overlap.tEnd2, overlap.tEnd1)], nil];
+                        }else if(path1Element.isLine() && path2Element.isLine()){
+                            // in this case, the two elements are both lines, so they can intersect at
+                            // only 1 place.
+                            // TODO: should i return two intersections if they're tangent?
+                            CGPoint intersection = [UIBezierPath intersects2D:bez1[0] to:bez1[3] andLine:bez2[0] to:bez2[3]];
+                            if(!CGPointEqualToPoint(intersection,CGPointNotFound)){
+                                CGFloat path1TValue = distance(bez1[0], intersection) / distance(bez1[0], bez1[3]);
+                                CGFloat path2TValue = distance(bez2[0], intersection) / distance(bez2[0], bez2[3]);
+                                if(path1TValue >= 0 && path1TValue <= 1 &&
+                                   path2TValue >= 0 && path2TValue <= 1){
+                                    intersections = [NSArray arrayWithObject:[NSValue valueWithCGPoint:CGPointMake(path2TValue, path1TValue)]];
                                 }else{
-                                    // at least one of the curves is a proper bezier, so use our
-                                    // bezier intersection algorithm to find possibly multiple intersections
-                                    // between these curves
-                                    intersections = [UIBezierPath findIntersectionsBetweenBezier:bez1 andBezier:bez2];
-                                }
-                                // loop through the intersections that we've found, and add in
-                                // some context that we can save for each one.
-                                for(NSValue* val in intersections){
-                                    CGFloat tValue1 = [val CGPointValue].y;
-                                    CGFloat tValue2 = [val CGPointValue].x;
-                                    // estimated length along each curve until the intersection is hit
-                                    CGFloat lenTillPath1Inter = path1EstimatedLength + tValue1 * path1EstimatedElementLength;
-                                    CGFloat lenTillPath2Inter = path2EstimatedLength + tValue2 * path2ElementLength;
-                                    
-                                    DKUIBezierPathIntersectionPoint* inter = [DKUIBezierPathIntersectionPoint intersectionAtElementIndex:path1ElementIndex
-                                                                                                                               andTValue:tValue1
-                                                                                                                        withElementIndex:path2ElementIndex
-                                                                                                                               andTValue:tValue2
-                                                                                                                        andElementCount1:elementCount1
-                                                                                                                        andElementCount2:elementCount2
-                                                                                                                  andLengthUntilPath1Loc:lenTillPath1Inter
-                                                                                                                  andLengthUntilPath2Loc:lenTillPath2Inter];
-                                    // store the two paths that the intersection relates to. these are
-                                    // the paths that match each of the CGPathElements that we used to
-                                    // find the intersection
-                                    inter.bez1[0] = bez1[0];
-                                    inter.bez1[1] = bez1[1];
-                                    inter.bez1[2] = bez1[2];
-                                    inter.bez1[3] = bez1[3];
-                                    inter.bez2[0] = bez2[0];
-                                    inter.bez2[1] = bez2[1];
-                                    inter.bez2[2] = bez2[2];
-                                    inter.bez2[3] = bez2[3];
-                                    
-                                    if(didFlipPathNumbers){
-                                        // we flipped the order that we're looking through paths,
-                                        // so we need to flip the intersection indexes so that
-                                        // bez1 is always the unclosed path and bez2 is always closed
-                                        inter = [inter flipped];
-                                    }
-                                    
-                                    // add to our output!
-                                    [foundIntersections addObject:inter];
+                                    // doesn't intersect within allowed T values
                                 }
                             }
-                            // track our full path length
-                            path2EstimatedLength += path2ElementLength;
                         }else{
-                            // it's a moveto element, so update our starting
-                            // point for this subpath within the full path
-                            path2StartingPoint = path2Element.points[0];
+                            // at least one of the curves is a proper bezier, so use our
+                            // bezier intersection algorithm to find possibly multiple intersections
+                            // between these curves
+                            intersections = [UIBezierPath findIntersectionsBetweenBezier:bez1
+                                                                               andBezier:bez2
+                                                                             withFatLine:path1Element.hasFatLine ? &path1Element.fatLine : NULL
+                                                                              andFatLine:path2Element.hasFatLine ? &path2Element.fatLine : NULL];
+                        }
+                        // loop through the intersections that we've found, and add in
+                        // some context that we can save for each one.
+                        for(NSValue* val in intersections){
+                            CGFloat tValue1 = [val CGPointValue].y;
+                            CGFloat tValue2 = [val CGPointValue].x;
+                            // estimated length along each curve until the intersection is hit
+                            CGFloat lenTillPath1Inter = path1EstimatedLength + tValue1 * path1EstimatedElementLength;
+                            CGFloat lenTillPath2Inter = path2LengthBeforeElement + tValue2 * path2ElementLength;
+                            
+                            DKUIBezierPathIntersectionPoint* inter = [DKUIBezierPathIntersectionPoint intersectionAtElementIndex:path1ElementIndex
+                                                                                                                       andTValue:tValue1
+                                                                                                                withElementIndex:path2ElementIndex
+                                                                                                                       andTValue:tValue2
+                                                                                                                andElementCount1:elementCount1
+                                                                                                                andElementCount2:elementCount2
+                                                                                                          andLengthUntilPath1Loc:lenTillPath1Inter
+                                                                                                          andLengthUntilPath2Loc:lenTillPath2Inter];
+                            // store the two paths that the intersection relates to. these are
+                            // the paths that match each of the CGPathElements that we used to
+                            // find the intersection
+                            inter.bez1[0] = bez1[0];
+                            inter.bez1[1] = bez1[1];
+                            inter.bez1[2] = bez1[2];
+                            inter.bez1[3] = bez1[3];
+                            inter.bez2[0] = bez2[0];
+                            inter.bez2[1] = bez2[1];
+                            inter.bez2[2] = bez2[2];
+                            inter.bez2[3] = bez2[3];
+                            
+                            if(didFlipPathNumbers){
+                                // we flipped the order that we're looking through paths,
+                                // so we need to flip the intersection indexes so that
+                                // bez1 is always the unclosed path and bez2 is always closed
+                                inter = [inter flipped];
+                            }
+                            
+                            // add to our output!
+                            [foundIntersections addObject:inter];
                         }
-                    }];
+                    }
+                    // track our full path length
+                    path2LengthBeforeElement += path2ElementLength;
                 }
-                path1EstimatedLength += path1EstimatedElementLength;
-            }else{
-                // it's a moveto element, so update our starting
-                // point for this subpath within the full path
-                path1StartingPoint = path1Element.points[0];
             }
-        }];
+            path1EstimatedLength += path1EstimatedElementLength;
+        }
         
         // make sure we have the points sorted by the intersection location
         // inside of self instead of inside the closed curve
@@ -291,77 +564,7 @@ static NSInteger segmentCompareCount = 0;
             }
         }];
         
-        // save all of our intersections, we may need this reference
-        // later if we filter out too many intersections as duplicates
-        NSArray* allFoundIntersections = foundIntersections;
-        
-        // iterate over the intersections and filter out duplicates
-        __block DKUIBezierPathIntersectionPoint* lastInter = [foundIntersections lastObject];
-        foundIntersections = [NSMutableArray arrayWithArray:[foundIntersections filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^(id obj, NSDictionary*bindings){
-            DKUIBezierPathIntersectionPoint* intersection = obj;
-            BOOL isDistinctIntersection = ![obj matchesElementEndpointWithIntersection:lastInter];
-            CGPoint interLoc = intersection.location1;
-            CGPoint lastLoc = lastInter.location1;
-            CGPoint interLoc2 = intersection.location2;
-            CGPoint lastLoc2 = lastInter.location2;
-            if(isDistinctIntersection){
-                if((ABS(interLoc.x - lastLoc.x) < kUIBezierClosenessPrecision &&
-                   ABS(interLoc.y - lastLoc.y) < kUIBezierClosenessPrecision) ||
-                   (ABS(interLoc2.x - lastLoc2.x) < kUIBezierClosenessPrecision &&
-                    ABS(interLoc2.y - lastLoc2.y) < kUIBezierClosenessPrecision)){
-                    // the points are close, but they might not necessarily be the same intersection.
-                    // for instance, a curve could be a very very very sharp V, and the intersection could
-                    // be slicing through the middle of the V to look like an ∀
-                    // the distance between the intersections along the - might be super small,
-                    // but along the V is much much further and should count as two intersections
-                    
-                    BOOL closeLocation1 = [lastInter isCloseToIntersection:intersection withPrecision:kUIBezierClosenessPrecision];
-                    BOOL closeLocation2 = [[lastInter flipped] isCloseToIntersection:[intersection flipped] withPrecision:kUIBezierClosenessPrecision];
-                    
-                    if(closeLocation1 != closeLocation2){
-                        NSLog(@"gotcha");
-                    }
-                    
-                    isDistinctIntersection = !closeLocation1 || !closeLocation2;
-                }
-            }
-            if(isDistinctIntersection){
-                lastInter = obj;
-            }
-            return isDistinctIntersection;
-        }]]];
-        
-        if(![foundIntersections count] && [allFoundIntersections count]){
-            // we accidentally filter out all of the points, because
-            // they all matched
-            // so add just 1 back in
-            [foundIntersections addObject:[allFoundIntersections firstObject]];
-        }else{
-            // sort exact match intersections out of the flipped intersections
-            // [MMClippingBezierIntersectionTests testLineNearBoundary]
-            NSMutableArray* originallyFoundIntersections = [NSMutableArray arrayWithArray:foundIntersections];
-            [foundIntersections sortUsingComparator:^NSComparisonResult(id obj1, id obj2){
-                if([obj1 elementIndex2] < [obj2 elementIndex2]){
-                    return NSOrderedAscending;
-                }else if([obj1 elementIndex2] == [obj2 elementIndex2] &&
-                         [obj1 tValue2] < [obj2 tValue2]){
-                    return NSOrderedAscending;
-                }
-                return NSOrderedDescending;
-            }];
-            
-            __block DKUIBezierPathIntersectionPoint* lastInter = nil;
-            [foundIntersections enumerateObjectsUsingBlock:^(DKUIBezierPathIntersectionPoint* obj, NSUInteger idx, BOOL *stop) {
-                if([[lastInter flipped] matchesElementEndpointWithIntersection:[obj flipped]]){
-                    [originallyFoundIntersections removeObject:obj];
-                };
-                lastInter = obj;
-            }];
-            // this way, the sort order of the original foundIntersections
-            // is maintained, and is also filtered to exclude intersections
-            // that exactly match their flipped state
-            foundIntersections = originallyFoundIntersections;
-        }
+        foundIntersections = [UIBezierPath distinctIntersectionsFrom:foundIntersections];
         
         //
         // next i need to filter all of the intersections to
@@ -372,122 +575,232 @@ static NSInteger segmentCompareCount = 0;
         // removed. also, if self intersects the shape along a straight line,
         // then many intersection points will be found instead of just the
         // end points.
-        if([closedPath isClosed]){
-            // we only need to check for boundary crossing if
-            // the path is closed, otherwise they're all moving from
-            // "outside" to "outside" the shape
-            //
-            // know if we're inside or outside the closed shape when we
-            // begin. then only save the intersections that will move us
-            // in/out of the shape, and ignore any intersections that
-            // don't change in/out
-            //
-            // this means we need to *ignore* tangents to circles,
-            // but may accept tangents to squares if the line
-            // is "in" the shape during the tangent
-            DKUIBezierPathIntersectionPoint* firstIntersection = [foundIntersections firstObject];
-            DKUIBezierPathIntersectionPoint* lastIntersection = [foundIntersections lastObject];
-            BOOL isInside = [closedPath containsPoint:self.firstPoint];
-            if(isInside && firstIntersection.elementIndex1 != 1 && firstIntersection.tValue1 != 0){
-                // double check that the first line segment is actually inside, and
-                // not just tangent at self.firstPoint
-                CGFloat firstTValue = firstIntersection.tValue1 / 2;
-                CGPoint* bezToUseForNextPoint = firstIntersection.bez1;
-                CGPoint locationAfterIntersection = [UIBezierPath pointAtT:firstTValue forBezier:bezToUseForNextPoint];
-                isInside = isInside && [closedPath containsPoint:locationAfterIntersection];
-            }
-            if(beginsInside){
-                *beginsInside = isInside;
-            }
-            if(lastIntersection == [foundIntersections firstObject]){
-                // make sure not to compare the first and last intersection
-                // if they're the same
-                lastIntersection = nil;
-            }
-            for(int i=0;i<[foundIntersections count];i++){
-                DKUIBezierPathIntersectionPoint* intersection = [foundIntersections objectAtIndex:i];
+        [self markBoundaryCrossingsOfIntersections:foundIntersections withClosedPath:closedPath andBeginsInside:beginsInside];
+        
+        // the segment and shape building compares these intersections
+        // to each other over and over, so give them ids to compare instead
+        [DKUIBezierPathIntersectionPoint assignIdsToIntersections:foundIntersections];
+        
+        return  [foundIntersections copy];
+    }
+
+    return [NSArray array];
+}
+
+/**
+ * filters out intersections that were found more than once,
+ * like at the shared end points of two elements, or as a cluster
+ * of points along a stretch where the curves barely touch. the
+ * intersections need to be sorted by their location along path 1.
+ */
++(NSMutableArray*) distinctIntersectionsFrom:(NSArray*)allFoundIntersections{
+    // iterate over the intersections and filter out duplicates
+    __block DKUIBezierPathIntersectionPoint* lastInter = [allFoundIntersections lastObject];
+    NSMutableArray* foundIntersections = [NSMutableArray arrayWithArray:[allFoundIntersections filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^(id obj, NSDictionary*bindings){
+        DKUIBezierPathIntersectionPoint* intersection = obj;
+        BOOL isDistinctIntersection = ![obj matchesElementEndpointWithIntersection:lastInter];
+        CGPoint interLoc = intersection.location1;
+        CGPoint lastLoc = lastInter.location1;
+        CGPoint interLoc2 = intersection.location2;
+        CGPoint lastLoc2 = lastInter.location2;
+        if(isDistinctIntersection){
+            if((ABS(interLoc.x - lastLoc.x) < kUIBezierClosenessPrecision &&
+               ABS(interLoc.y - lastLoc.y) < kUIBezierClosenessPrecision) ||
+               (ABS(interLoc2.x - lastLoc2.x) < kUIBezierClosenessPrecision &&
+                ABS(interLoc2.y - lastLoc2.y) < kUIBezierClosenessPrecision)){
+                // the points are close, but they might not necessarily be the same intersection.
+                // for instance, a curve could be a very very very sharp V, and the intersection could
+                // be slicing through the middle of the V to look like an ∀
+                // the distance between the intersections along the - might be super small,
+                // but along the V is much much further and should count as two intersections
                 
-                DKUIBezierPathIntersectionPoint* nextIntersection = nil;
-                if(i < [foundIntersections count] - 1){
-                    nextIntersection = [foundIntersections objectAtIndex:i+1];
-                }
+                BOOL closeLocation1 = [lastInter isCloseToIntersection:intersection withPrecision:kUIBezierClosenessPrecision];
+                BOOL closeLocation2 = [[lastInter flipped] isCloseToIntersection:[intersection flipped] withPrecision:kUIBezierClosenessPrecision];
                 
-                CGPoint* bezToUseForNextPoint = intersection.bez1;
-                // if the next intersection isn't in the same element, then we
-                // can test a point halfway between our intersection and the end
-                // of the element to see if we're inside/outside the closed shape
-                CGFloat nextTValue = (intersection.tValue1 + 1.0) / 2.0;
-                if(nextIntersection && nextIntersection.elementIndex1 == intersection.elementIndex1){
-                    // welp, our next intersection is inside the same element,
-                    // so average our intersection points to see if we're inside/
-                    // outside the shape
-                    nextTValue = (intersection.tValue1 + nextIntersection.tValue1) / 2.0;
+                if(closeLocation1 != closeLocation2){
+                    NSLog(@"gotcha");
                 }
-                if(nextTValue == intersection.tValue1){
-                    // our "next" value to check is the same as the point we're
-                    // already looking at. so look at the next element instead
-                    if(nextIntersection){
-                        nextTValue = nextIntersection.tValue1 / 2;
-                        bezToUseForNextPoint = nextIntersection.bez1;
+                
+                isDistinctIntersection = !closeLocation1 || !closeLocation2;
+            }
+        }
+        if(isDistinctIntersection){
+            lastInter = obj;
+        }
+        return isDistinctIntersection;
+    }]]];
+    
+    if(![foundIntersections count] && [allFoundIntersections count]){
+        // we accidentally filter out all of the points, because
+        // they all matched
+        // so add just 1 back in
+        [foundIntersections addObject:[allFoundIntersections firstObject]];
+    }else{
+        // sort exact match intersections out of the flipped intersections
+        // [MMClippingBezierIntersectionTests testLineNearBoundary]
+        NSMutableArray* originallyFoundIntersections = [NSMutableArray arrayWithArray:foundIntersections];
+        [foundIntersections sortUsingComparator:^NSComparisonResult(id obj1, id obj2){
+            if([obj1 elementIndex2] < [obj2 elementIndex2]){
+                return NSOrderedAscending;
+            }else if([obj1 elementIndex2] == [obj2 elementIndex2] &&
+                     [obj1 tValue2] < [obj2 tValue2]){
+                return NSOrderedAscending;
+            }
+            return NSOrderedDescending;
+        }];
+        
+        __block DKUIBezierPathIntersectionPoint* lastInter = nil;
+        [foundIntersections enumerateObjectsUsingBlock:^(DKUIBezierPathIntersectionPoint* obj, NSUInteger idx, BOOL *stop) {
+            if([[lastInter flipped] matchesElementEndpointWithIntersection:[obj flipped]]){
+                [originallyFoundIntersections removeObject:obj];
+            };
+            lastInter = obj;
+        }];
+        // this way, the sort order of the original foundIntersections
+        // is maintained, and is also filtered to exclude intersections
+        // that exactly match their flipped state
+        foundIntersections = originallyFoundIntersections;
+    }
+    return foundIntersections;
+}
+
+/**
+ * sets mayCrossBoundary on each of the intersections, which must be
+ * sorted by their location along self, and fills in beginsInside.
+ * if the closedPath isn't closed, none of the intersections cross its
+ * boundary, and beginsInside is left alone.
+ */
+-(void) markBoundaryCrossingsOfIntersections:(NSArray*)foundIntersections withClosedPath:(UIBezierPath*)closedPath andBeginsInside:(BOOL*)beginsInside{
+    if([closedPath isClosed]){
+        // we only need to check for boundary crossing if
+        // the path is closed, otherwise they're all moving from
+        // "outside" to "outside" the shape
+        [self markBoundaryCrossingsOfIntersections:foundIntersections withContainment:^BOOL(CGPoint point){
+            return [closedPath containsPoint:point];
+        } andBeginsInside:beginsInside];
+    }else{
+        // intersections that were flipped from a search against
+        // a closed path still carry its crossings, so clear them
+        for(DKUIBezierPathIntersectionPoint* intersection in foundIntersections){
+            intersection.mayCrossBoundary = NO;
+        }
+    }
+}
+
+/**
+ * the same as above, but asks containsPoint instead of a path
+ * if each point along self is inside the shape or not
+ */
+-(void) markBoundaryCrossingsOfIntersections:(NSArray*)foundIntersections withContainment:(BOOL (^)(CGPoint point))containsPoint andBeginsInside:(BOOL*)beginsInside{
+    // know if we're inside or outside the closed shape when we
+    // begin. then only save the intersections that will move us
+    // in/out of the shape, and ignore any intersections that
+    // don't change in/out
+    //
+    // this means we need to *ignore* tangents to circles,
+    // but may accept tangents to squares if the line
+    // is "in" the shape during the tangent
+    DKUIBezierPathIntersectionPoint* firstIntersection = [foundIntersections firstObject];
+    DKUIBezierPathIntersectionPoint* lastIntersection = [foundIntersections lastObject];
+    BOOL isInside = containsPoint(self.firstPoint);
+    if(isInside && firstIntersection.elementIndex1 != 1 && firstIntersection.tValue1 != 0){
+        // double check that the first line segment is actually inside, and
+        // not just tangent at self.firstPoint
+        CGFloat firstTValue = firstIntersection.tValue1 / 2;
+        CGPoint* bezToUseForNextPoint = firstIntersection.bez1;
+        CGPoint locationAfterIntersection = [UIBezierPath pointAtT:firstTValue forBezier:bezToUseForNextPoint];
+        isInside = isInside && containsPoint(locationAfterIntersection);
+    }
+    if(beginsInside){
+        *beginsInside = isInside;
+    }
+    if(lastIntersection == [foundIntersections firstObject]){
+        // make sure not to compare the first and last intersection
+        // if they're the same
+        lastIntersection = nil;
+    }
+    for(int i=0;i<[foundIntersections count];i++){
+        DKUIBezierPathIntersectionPoint* intersection = [foundIntersections objectAtIndex:i];
+        
+        DKUIBezierPathIntersectionPoint* nextIntersection = nil;
+        if(i < [foundIntersections count] - 1){
+            nextIntersection = [foundIntersections objectAtIndex:i+1];
+        }
+        
+        CGPoint* bezToUseForNextPoint = intersection.bez1;
+        // the point bezier for the next element goes here, instead of over
+        // the intersection's own bez1, which later segment building reads
+        CGPoint pointBez[4];
+        // if the next intersection isn't in the same element, then we
+        // can test a point halfway between our intersection and the end
+        // of the element to see if we're inside/outside the closed shape
+        CGFloat nextTValue = (intersection.tValue1 + 1.0) / 2.0;
+        if(nextIntersection && nextIntersection.elementIndex1 == intersection.elementIndex1){
+            // welp, our next intersection is inside the same element,
+            // so average our intersection points to see if we're inside/
+            // outside the shape
+            nextTValue = (intersection.tValue1 + nextIntersection.tValue1) / 2.0;
+        }
+        if(nextTValue == intersection.tValue1){
+            // our "next" value to check is the same as the point we're
+            // already looking at. so look at the next element instead
+            if(nextIntersection){
+                nextTValue = nextIntersection.tValue1 / 2;
+                bezToUseForNextPoint = nextIntersection.bez1;
+            }else{
+                // no next intersection, check if we have a next element
+                if(intersection.elementIndex1 < [self elementCount]-1){
+                    nextTValue = 1;
+                    // since the next element is entirely within the next segment,
+                    // we can just use it as a point bezier
+                    bezToUseForNextPoint = pointBez;
+                    CGPathElement ele = [self elementAtIndex:intersection.elementIndex1+1];
+                    if(ele.type != kCGPathElementCloseSubpath){
+                        bezToUseForNextPoint[0] = ele.points[0];
+                        bezToUseForNextPoint[1] = ele.points[0];
+                        bezToUseForNextPoint[2] = ele.points[0];
+                        bezToUseForNextPoint[3] = ele.points[0];
                     }else{
-                        // no next intersection, check if we have a next element
-                        if(intersection.elementIndex1 < [self elementCount]-1){
-                            nextTValue = 1;
-                            // since the next element is entirely within the next segment,
-                            // we can just use it as a point bezier
-                            CGPathElement ele = [self elementAtIndex:intersection.elementIndex1+1];
-                            if(ele.type != kCGPathElementCloseSubpath){
-                                bezToUseForNextPoint[0] = ele.points[0];
-                                bezToUseForNextPoint[1] = ele.points[0];
-                                bezToUseForNextPoint[2] = ele.points[0];
-                                bezToUseForNextPoint[3] = ele.points[0];
-                            }else{
-                                CGPoint p = CGPointZero;
-                                CGPathElement ele = [self elementAtIndex:intersection.elementIndex1];
-                                if(ele.type == kCGPathElementMoveToPoint || ele.type == kCGPathElementAddLineToPoint){
-                                    p = ele.points[0];
-                                }else if(ele.type == kCGPathElementAddQuadCurveToPoint){
-                                    p = ele.points[1];
-                                }else if(ele.type == kCGPathElementAddQuadCurveToPoint){
-                                    p = ele.points[2];
-                                }
-                                bezToUseForNextPoint[0] = p;
-                                bezToUseForNextPoint[1] = p;
-                                bezToUseForNextPoint[2] = p;
-                                bezToUseForNextPoint[3] = p;
-                            }
+                        CGPoint p = CGPointZero;
+                        CGPathElement ele = [self elementAtIndex:intersection.elementIndex1];
+                        if(ele.type == kCGPathElementMoveToPoint || ele.type == kCGPathElementAddLineToPoint){
+                            p = ele.points[0];
+                        }else if(ele.type == kCGPathElementAddQuadCurveToPoint){
+                            p = ele.points[1];
+                        }else if(ele.type == kCGPathElementAddQuadCurveToPoint){
+                            p = ele.points[2];
                         }
+                        bezToUseForNextPoint[0] = p;
+                        bezToUseForNextPoint[1] = p;
+                        bezToUseForNextPoint[2] = p;
+                        bezToUseForNextPoint[3] = p;
                     }
                 }
-                
-                // this will give us a point that comes after the intersection
-                // to tell is us if we're inside or outside the shape
-                CGPoint locationAfterIntersection = [UIBezierPath pointAtT:nextTValue forBezier:bezToUseForNextPoint];
-                
-                // find out if we're inside or outside after this intersection,
-                // and if we're at a tangent
-                BOOL endsInTangent = NO;
-                if(!nextIntersection && intersection.tValue1 == 1 && intersection.elementIndex1 == self.elementCount - 1){
-                    endsInTangent = YES;
-                }
-                BOOL isInsideAfterIntersection = [closedPath containsPoint:locationAfterIntersection];
-                
-                if(!endsInTangent){
-                    // we found an intersection that crosses the boundary of the shape,
-                    // so mark it as such
-                    intersection.mayCrossBoundary = isInside != isInsideAfterIntersection;
-                }
-                
-                // setup for next iteration of loop
-                lastIntersection = intersection;
-                isInside = isInsideAfterIntersection;
             }
         }
         
-        return  [foundIntersections copy];
+        // this will give us a point that comes after the intersection
+        // to tell is us if we're inside or outside the shape
+        CGPoint locationAfterIntersection = [UIBezierPath pointAtT:nextTValue forBezier:bezToUseForNextPoint];
+        
+        // find out if we're inside or outside after this intersection,
+        // and if we're at a tangent
+        BOOL endsInTangent = NO;
+        if(!nextIntersection && intersection.tValue1 == 1 && intersection.elementIndex1 == self.elementCount - 1){
+            endsInTangent = YES;
+        }
+        BOOL isInsideAfterIntersection = containsPoint(locationAfterIntersection);
+        
+        if(!endsInTangent){
+            // we found an intersection that crosses the boundary of the shape,
+            // so mark it as such
+            intersection.mayCrossBoundary = isInside != isInsideAfterIntersection;
+        }
+        
+        // setup for next iteration of loop
+        lastIntersection = intersection;
+        isInside = isInsideAfterIntersection;
     }
-
-    return [NSArray array];
 }
 
 
@@ -505,8 +818,6 @@ static NSInteger segmentCompareCount = 0;
  * will be wrong
  */
 -(DKUIBezierPathClippingResult*) clipUnclosedPathToClosedPath:(UIBezierPath*)closedPath usingIntersectionPoints:(NSArray*)intersectionPoints andBeginsInside:(BOOL)beginsInside{
-    __block UIBezierPath* currentIntersectionSegment = [UIBezierPath bezierPath];
-    
     //
     // first, the base case:
     // closed path with 1 or fewer intersections, or no intersections at all
@@ -635,7 +946,6 @@ static NSInteger segmentCompareCount = 0;
     // get the array of all intersections
     NSMutableArray* tValuesOfIntersectionPoints = [NSMutableArray arrayWithArray:intersectionPoints];
     
-    NSMutableArray* originalTValuesOfIntersectionPoints = [tValuesOfIntersectionPoints mutableCopy];
     NSInteger countOfIntersections = [tValuesOfIntersectionPoints count];
     //
     // track special case if we start at an intersection
@@ -649,8 +959,8 @@ static NSInteger segmentCompareCount = 0;
     // and not the difference. whenever we hit an intersection, we'll
     // just swap the intersection/difference pointers so that we'll
     // continually toggle which array we're adding to.
-    __block NSMutableArray* actingintersectionSegments = intersectionSegments;
-    __block NSMutableArray* actingdifferenceSegments = differenceSegments;
+    NSMutableArray* actingintersectionSegments = intersectionSegments;
+    NSMutableArray* actingdifferenceSegments = differenceSegments;
     
     CGPoint firstPoint = self.firstPoint;
     if(![closedPath containsPoint:firstPoint] || !beginsInside || ![closedPath isClosed]){
@@ -665,13 +975,13 @@ static NSInteger segmentCompareCount = 0;
     NSMutableArray* firstIntersectionSegments = actingintersectionSegments;
     
     // most recent tValue that we've looked at as we traverse over the path. begin with the start point
-    __block DKUIBezierPathIntersectionPoint* lastTValue = nil;
-    DKUIBezierPathIntersectionPoint* firstTValue = [originalTValuesOfIntersectionPoints firstObject];
+    DKUIBezierPathIntersectionPoint* lastTValue = nil;
+    DKUIBezierPathIntersectionPoint* firstTValue = [tValuesOfIntersectionPoints firstObject];
     if([self isClosed]){
         // if we're closed, then the last intersection we've looked at
         // is the last intersection in the path. from there, it loops
         // around back through the start of the path
-        lastTValue = [originalTValuesOfIntersectionPoints lastObject];
+        lastTValue = [tValuesOfIntersectionPoints lastObject];
     }else{
         // of unclosed paths, the "most recent" intersection is the non-intersection
         // of the start of the path. not sure why we're not using firstIntersectionIsStartOfPath
@@ -688,86 +998,54 @@ static NSInteger segmentCompareCount = 0;
     
     DKUIBezierUnmatchedPathIntersectionPoint* endOfTheLine = [DKUIBezierUnmatchedPathIntersectionPoint intersectionAtElementIndex:self.elementCount-1 andTValue:1 withElementIndex:NSNotFound andTValue:0 andElementCount1:self.elementCount andElementCount2:closedPath.elementCount andLengthUntilPath1Loc:self.length andLengthUntilPath2Loc:0];
     
-    CGPoint selfPathStartingPoint = self.firstPoint;
-    
-    __block BOOL closedPathIsPoint = NO;
-    
-    __block BOOL lastElementIsClosePath = NO;
-    __block CGPoint startingPoint = CGPointNotFound;
-    [self iteratePathWithBlock:^(CGPathElement element, NSUInteger currentElementIndex){
+    // each segment is only the element and t value that it starts
+    // and ends at in this table. none of their paths are built
+    // until they're asked for
+    std::shared_ptr<const DKPathElementTable> elementTable = std::make_shared<DKPathElementTable>(self);
+    NSInteger elementCount = elementTable->count();
+    // where the segment that the next intersection ends begins
+    NSInteger segmentStartElement = 0;
+    CGFloat segmentStartT = 0;
+    
+    BOOL closedPathIsPoint = NO;
+    BOOL lastElementIsClosePath = NO;
+    for(NSInteger currentElementIndex = 0; currentElementIndex < elementCount; currentElementIndex++){
+        throwIfClippingCancelled();
+        const DKPathElement& element = (*elementTable)[currentElementIndex];
         if(![tValuesOfIntersectionPoints count] || currentElementIndex != [[tValuesOfIntersectionPoints firstObject] elementIndex1]){
-            // no intersection between these two elements, so add the
-            // element to the output
+            // no intersection in this element, so it's
+            // included whole in the current segment
             if(element.type == kCGPathElementCloseSubpath){
-                if(CGPointEqualToPoint(currentIntersectionSegment.lastPoint, self.firstPoint)){
+                if(CGPointEqualToPoint(element.bez[0], element.bez[3])){
                     // track if the closePathElement actually gives us a line segment,
                     // or if the rest of the path was already visually closed
                     closedPathIsPoint = YES;
                 }
-                // TODO: future optimization here would be to skip the line-to
-                // if the path is already at the self.firstPoint...
-                [currentIntersectionSegment addLineToPoint:self.firstPoint];
-                if(currentElementIndex == self.elementCount - 1){
+                if(currentElementIndex == elementCount - 1){
                     lastElementIsClosePath = YES;
                 }
-            }else{
-                // no intersection, just add the element
-                [currentIntersectionSegment addPathElement:element];
             }
         }else{
             // they intersect, so this will change our intersection vs difference.
             // also, we may have multiple intersections inside the same element, so
             // we'll handle that too
-            
-            CGPoint bez[4];
-            // track our initial bezier curve
-            startingPoint = [UIBezierPath fillCGPoints:bez
-                                           withElement:element
-                             givenElementStartingPoint:startingPoint
-                               andSubPathStartingPoint:selfPathStartingPoint];
-            
-            BOOL hasRight = YES;
             while([[tValuesOfIntersectionPoints firstObject] elementIndex1] == currentElementIndex){
-                // get the T-value of the intersection in self's element.
-                // if this element had been split before, then this tValue may
-                // have been adjust from the origin tvalue intersection
-                CGFloat tValue = [[tValuesOfIntersectionPoints firstObject] tValue1];
-                if(tValue == 1){
-                    hasRight = NO;
-                }
-                
-                // split us into left/right
-                CGPoint left[4];
-                CGPoint right[4];
-                [UIBezierPath subdivideBezier:bez intoLeft:left andRight:right atT:tValue];
-                
-                // add the path element to the intersection
-                if(tValue > 0){
-                    // if the tValue is 0, then the intersection really happened at the
-                    // end of the last element, so we don't need to add a curve to a single point
-                    // here. instead just skip it and only add a curve that has a size larger
-                    // than a single point.
-                    if(element.type != kCGPathElementAddLineToPoint && element.type != kCGPathElementCloseSubpath){
-                        [currentIntersectionSegment addCurveToPoint:left[3] controlPoint1:left[1] controlPoint2:left[2]];
-                    }else{
-                        [currentIntersectionSegment addLineToPoint:left[3]];
-                    }
-                }
-                
-                // currTValue is always the unadjusted tvalue of the intersection
-                // between the curves
-                DKUIBezierPathIntersectionPoint* currTValue = [originalTValuesOfIntersectionPoints objectAtIndex:0];
+                DKUIBezierPathIntersectionPoint* currTValue = [tValuesOfIntersectionPoints firstObject];
                 if(currTValue != lastTValue){
                     // just in case the first intersection is exactly
                     // on a boundary, then we'll want to skip creating a segment
                     // that is exactly 1 px large (distance of 0)
                     [actingintersectionSegments addObject:[DKUIBezierPathClippedSegment clippedPairWithStart:lastTValue
                                                                                                      andEnd:currTValue
-                                                                                             andPathSegment:currentIntersectionSegment
+                                                                                                fromElement:segmentStartElement
+                                                                                                        atT:segmentStartT
+                                                                                                  toElement:currentElementIndex
+                                                                                                        atT:currTValue.tValue1
+                                                                                                    inTable:elementTable
                                                                                                fromFullPath:self]];
                 }
                 lastTValue = currTValue;
-                if([[tValuesOfIntersectionPoints firstObject] mayCrossBoundary]){
+                if([currTValue mayCrossBoundary]){
                     // this intersection causes a boundary crossing, so switch
                     // our intersection and difference
                     // swap inside/outside
@@ -778,92 +1056,17 @@ static NSInteger segmentCompareCount = 0;
                     // the intersection does not cross the boundary of the
                     // shape
                 }
-                if(hasRight || currentElementIndex != self.elementCount - 1){
-                    // don't add the trailing moveTo if there won't
-                    // be any more segments to add to it
-                    currentIntersectionSegment = [UIBezierPath bezierPath];
-                    [currentIntersectionSegment moveToPoint:left[3]];
-                }
-
-
+                segmentStartElement = currentElementIndex;
+                segmentStartT = currTValue.tValue1;
+                
                 // now remove this intersection since it's been
                 // processed. as we loop back around the while loop
                 // this'll let us continually use the [tValuesOfIntersectionPoints firstObject]
                 // to process through all intersections in this element.
                 [tValuesOfIntersectionPoints removeObjectAtIndex:0];
-                [originalTValuesOfIntersectionPoints removeObjectAtIndex:0];
-                
-                // and scale the remaining intersection
-                // T values for this element index.
-                // we've essentially cut the element in half,
-                // so the old intersection T values need to be
-                // scaled to the new element's size
-                for(int i=0;i<[tValuesOfIntersectionPoints count];i++){
-                    DKUIBezierPathIntersectionPoint* oldInter = [tValuesOfIntersectionPoints objectAtIndex:i];
-                    if([oldInter elementIndex1] == currentElementIndex){
-                        // this intersection matches the current element that
-                        // we just split, so adjust it's T values
-                        CGFloat oldT = [oldInter tValue1];
-                        CGFloat adjustedTValue = (oldT - tValue) / (1.0 - tValue);
-                        if(oldT == 1 || oldT == 0){
-                            // save if its on a boundary for rounding error
-                            adjustedTValue = oldT;
-                        }
-                        // create a new intersection, and replace it in the array
-                        DKUIBezierPathIntersectionPoint* newInter = [DKUIBezierPathIntersectionPoint intersectionAtElementIndex:oldInter.elementIndex1
-                                                                                                                      andTValue:adjustedTValue
-                                                                                                               withElementIndex:oldInter.elementIndex2
-                                                                                                                      andTValue:oldInter.tValue2
-                                                                                                               andElementCount1:oldInter.elementIndex1
-                                                                                                               andElementCount2:oldInter.elementIndex2
-                                                                                                         andLengthUntilPath1Loc:oldInter.lenAtInter1
-                                                                                                         andLengthUntilPath2Loc:oldInter.lenAtInter2];
-                        [newInter setMayCrossBoundary:oldInter.mayCrossBoundary];
-                        newInter.pathLength1 = oldInter.pathLength1;
-                        newInter.pathLength2 = oldInter.pathLength2;
-                        [tValuesOfIntersectionPoints replaceObjectAtIndex:i withObject:newInter];
-                        
-                    }
-                }
-                
-                // now move us over to the right side of what we just chopped
-                // and loop to deal with this half (if needed).
-                // if this was the last intersection in this element, then
-                // the loop will exit and we'll deal w/ the right half of the
-                // split below.
-                bez[0] = right[0];
-                bez[1] = right[1];
-                bez[2] = right[2];
-                bez[3] = right[3];
-            }
-            // if the intersection was at t=1, then there is
-            // no righthand side to add to the intersection,
-            // so just skip past adding a curve element
-            if(hasRight){
-                // ok, we've processed all intersections for this element,
-                // now add what's left of this element to the curve
-                // TODO: what happens if the element intersects at the end of the element at T = 1?
-                if(element.type != kCGPathElementAddLineToPoint && element.type != kCGPathElementCloseSubpath){
-                    [currentIntersectionSegment addCurveToPoint:bez[3] controlPoint1:bez[1] controlPoint2:bez[2]];
-                }else{
-                    [currentIntersectionSegment addLineToPoint:bez[3]];
-                }
-                // and now loop back around to the next element and begin
-                // the process all over for the rest of the path.
             }
         }
-        
-        if(element.type != kCGPathElementCloseSubpath){
-            // update our starting point for the next element
-            // NOTE: we don't handle close subpaths / move-to's and
-            // resetting the startpoint because this method only
-            // handles paths with a single subpath. multiple subpaths
-            // are not supported here. use redAndGreenAndBlueSegmentsCreatedFrom
-            // or similar instead for multiple subpaths.
-            startingPoint = element.points[[UIBezierPath numberOfPointsForElement:element]-1];
-        }
-    }];
-    
+    }
     
     if(lastTValue.tValue1 == 1 && ((closedPathIsPoint && lastElementIsClosePath && lastTValue.elementIndex1 == self.elementCount - 2) ||
                                          (!lastElementIsClosePath && lastTValue.elementIndex1 == self.elementCount - 1))){
@@ -878,7 +1081,11 @@ static NSInteger segmentCompareCount = 0;
         // so only add this last segment if it's not closed
         [actingintersectionSegments addObject:[DKUIBezierPathClippedSegment clippedPairWithStart:lastTValue
                                                                                          andEnd:endOfTheLine
-                                                                                 andPathSegment:currentIntersectionSegment
+                                                                                    fromElement:segmentStartElement
+                                                                                            atT:segmentStartT
+                                                                                      toElement:elementCount - 1
+                                                                                            atT:1
+                                                                                        inTable:elementTable
                                                                                    fromFullPath:self]];
     }else if([self isClosed]){
         // if we're closed, then the last loops around
@@ -886,57 +1093,84 @@ static NSInteger segmentCompareCount = 0;
         // this will merge the two segments and replace them in our output.
         if([firstIntersectionSegments count]){
             DKUIBezierPathClippedSegment* firstSeg = [firstIntersectionSegments firstObject];
-            [currentIntersectionSegment appendPathRemovingInitialMoveToPoint:firstSeg.pathSegment];
-            DKUIBezierPathClippedSegment* newSeg = [DKUIBezierPathClippedSegment clippedPairWithStart:firstSeg.startIntersection
-                                                                                               andEnd:firstSeg.endIntersection
-                                                                                       andPathSegment:currentIntersectionSegment
-                                                                                         fromFullPath:firstSeg.fullPath];
+            DKUIBezierPathClippedSegment* lastSeg = [DKUIBezierPathClippedSegment clippedPairWithStart:lastTValue
+                                                                                                andEnd:endOfTheLine
+                                                                                           fromElement:segmentStartElement
+                                                                                                   atT:segmentStartT
+                                                                                             toElement:elementCount - 1
+                                                                                                   atT:1
+                                                                                               inTable:elementTable
+                                                                                          fromFullPath:self];
+            DKUIBezierPathClippedSegment* newSeg = [[lastSeg prependTo:firstSeg] segmentWithStart:firstSeg.startIntersection
+                                                                                            andEnd:firstSeg.endIntersection
+                                                                                      fromFullPath:firstSeg.fullPath];
             [firstIntersectionSegments replaceObjectAtIndex:0 withObject:newSeg];
         }
     }
     
-    // now calculate the full intersection and difference paths
-    UIBezierPath* intersection = [UIBezierPath bezierPath];
-    UIBezierPath* difference = [UIBezierPath bezierPath];
-    for(DKUIBezierPathClippedSegment* seg in intersectionSegments){
-        if([seg.pathSegment elementCount] > 1){
-            [intersection appendPath:seg.pathSegment];
-        }
-    }
-    for(DKUIBezierPathClippedSegment* seg in differenceSegments){
-        if([seg.pathSegment elementCount] > 1){
-            [difference appendPath:seg.pathSegment];
-        }
+    // the full intersection and difference paths are
+    // built from the segments if they're asked for
+    return [[DKUIBezierPathClippingResult alloc] initWithIntersectionSegments:intersectionSegments
+                                                        andDifferenceSegments:differenceSegments
+                                                          andShellIntSegments:[intersectionSegments count]
+                                                         andShellDiffSegments:[differenceSegments count]];
+}
+
+
+
+/**
+ * this will calculate the red and green segments for a path, and will respect and account for all
+ * subpaths in the input scissor path
+ *
+ * since this method may be called from both sides of a cut - ie, using the shape as scissor and vice versa
+ * it needs to accept the intersections as input so that they're used exactly the same for both cuts
+ */
++(DKUIBezierPathClippingResult*) redAndGreenSegmentsCreatedFrom:(UIBezierPath*)shapePath bySlicingWithPath:(UIBezierPath*)scissorPath withIntersections:(NSArray*)_scissorToShapeIntersections{
+    return [UIBezierPath redAndGreenSegmentsCreatedFrom:shapePath bySlicingWithPath:scissorPath withIntersections:_scissorToShapeIntersections andShapeTable:NULL andScissorTable:NULL];
+}
+
+/**
+ * the same as above, but with element tables that were already built for
+ * the full shape and scissor paths. every subpath of the scissors is compared
+ * to the same shape table, instead of building a new one for each of them.
+ * either table can be NULL, and it'll be built here if it's needed.
+ */
++(DKUIBezierPathClippingResult*) redAndGreenSegmentsCreatedFrom:(UIBezierPath*)shapePath bySlicingWithPath:(UIBezierPath*)scissorPath withIntersections:(NSArray*)_scissorToShapeIntersections andShapeTable:(const DKPathElementTable*)shapeTable andScissorTable:(const DKPathElementTable*)scissorTable{
+    // every subpath is compared to the entire shape,
+    // so only work out the shape's elements once
+    std::unique_ptr<DKPathElementTable> shapeTableStorage;
+    if(!shapeTable){
+        shapeTableStorage.reset(new DKPathElementTable(shapePath, kUIBezierClippingPrecision));
+        shapeTable = shapeTableStorage.get();
     }
-    
-    return [[DKUIBezierPathClippingResult alloc] initWithIntersection:intersection
-                                                           andSegments:intersectionSegments
-                                                        andDifference:difference
-                                                           andSegments:differenceSegments
-                                                  andShellIntSegments:[intersectionSegments count]
-                                                 andShellDiffSegments:[differenceSegments count]];
+    return [UIBezierPath redAndGreenSegmentsCreatedFrom:shapePath bySlicingWithPath:scissorPath withIntersections:_scissorToShapeIntersections usingSubpathIntersections:^NSArray*(UIBezierPath* subScissors, BOOL* beginsInside){
+        // a scissor with only one subpath can use the
+        // table for the entire scissors as is
+        const DKPathElementTable* subScissorsTable = NULL;
+        if(scissorTable && [subScissors elementCount] == scissorTable->count()){
+            subScissorsTable = scissorTable;
+        }
+        return [subScissors findIntersectionsWithClosedPath:shapePath
+                                            andBeginsInside:beginsInside
+                                                  withTable:subScissorsTable
+                                         andClosedPathTable:shapeTable];
+    }];
 }
 
-
-
 /**
- * this will calculate the red and green segments for a path, and will respect and account for all
- * subpaths in the input scissor path
- *
- * since this method may be called from both sides of a cut - ie, using the shape as scissor and vice versa
- * it needs to accept the intersections as input so that they're used exactly the same for both cuts
+ * the same as above, but findSubpathIntersections finds the intersections
+ * of each subpath of the scissors with the shape, the same as
+ * findIntersectionsWithClosedPath:andBeginsInside: would
  */
-+(DKUIBezierPathClippingResult*) redAndGreenSegmentsCreatedFrom:(UIBezierPath*)shapePath bySlicingWithPath:(UIBezierPath*)scissorPath withIntersections:(NSArray*)_scissorToShapeIntersections{
++(DKUIBezierPathClippingResult*) redAndGreenSegmentsCreatedFrom:(UIBezierPath*)shapePath bySlicingWithPath:(UIBezierPath*)scissorPath withIntersections:(NSArray*)_scissorToShapeIntersections usingSubpathIntersections:(NSArray* (^)(UIBezierPath* subScissors, BOOL* beginsInside))findSubpathIntersections{
     // We'll clip twice, once clipping by the scissors to get the intersection/difference of the
     // scissor path compared to the shape
     NSMutableArray* scissorToShapeIntersections = [NSMutableArray arrayWithArray:_scissorToShapeIntersections];
     
     //
-    // these will track the full intersection and difference
-    // objects used to generate a full DKUIBezierPathClippingResult
-    // over the entire scissor path, not just each subpath
-    UIBezierPath* entireScissorIntersection = [UIBezierPath bezierPath];
-    UIBezierPath* entireScissorDifference = [UIBezierPath bezierPath];
+    // these will track the segments used to generate a full
+    // DKUIBezierPathClippingResult over the entire scissor
+    // path, not just each subpath
     NSMutableArray* intersectionSegments = [NSMutableArray array];
     NSMutableArray* differenceSegments = [NSMutableArray array];
     
@@ -1004,10 +1238,9 @@ static NSInteger segmentCompareCount = 0;
         }
         
         if(altStartInter || altEndInter){
-            return [DKUIBezierPathClippedSegment clippedPairWithStart:altStartInter ? altStartInter : seg.startIntersection
-                                                               andEnd:altEndInter ? altEndInter : seg.endIntersection
-                                                       andPathSegment:seg.pathSegment
-                                                         fromFullPath:scissorPath];
+            return [seg segmentWithStart:altStartInter ? altStartInter : seg.startIntersection
+                                  andEnd:altEndInter ? altEndInter : seg.endIntersection
+                            fromFullPath:scissorPath];
         }
         return seg;
     };
@@ -1016,23 +1249,28 @@ static NSInteger segmentCompareCount = 0;
     NSUInteger numberOfShellIntersectionSegments = 0;
     NSUInteger numberOfShellDifferenceSegments = 0;
     BOOL hasCountedShellSegments = NO;
+    
+    NSArray* scissorSubpaths = [scissorPath subPaths];
+    //
+    // TODO: clip every subpath in one pass over the scissor table, using
+    // each element's subpathIndex, so that nothing below needs remapping.
+    // that needs the intersection matching, boundary crossings and
+    // wraparound merge to work per subpath instead of per path.
     //
     // for all subpaths in the scissors, clip each subpath to the shape
     // and be sure to adjust all intersection points to map directly to the
     // overall scissor path instead of just the subpath.
-    for(UIBezierPath* subScissors in [scissorPath subPaths]){
+    for(UIBezierPath* subScissors in scissorSubpaths){
+        throwIfClippingCancelled();
         BOOL beginsInside1_alt = NO;
         // find intersections within only this subpath
-        NSMutableArray* subpathToShapeIntersections = [NSMutableArray arrayWithArray:[subScissors findIntersectionsWithClosedPath:shapePath andBeginsInside:&beginsInside1_alt]];
+        NSMutableArray* subpathToShapeIntersections = [NSMutableArray arrayWithArray:findSubpathIntersections(subScissors, &beginsInside1_alt)];
         // find all segments for only this subpath
         DKUIBezierPathClippingResult* subpathClippingResult = [subScissors clipUnclosedPathToClosedPath:shapePath usingIntersectionPoints:subpathToShapeIntersections andBeginsInside:beginsInside1_alt];
         
         // track our subpath intersections, so that we can map
         // them back to full path intersections
         [allSubpathToShapeIntersections addObjectsFromArray:subpathToShapeIntersections];
-        // update the entire difference/intersection paths
-        [entireScissorIntersection appendPath:subpathClippingResult.entireIntersectionPath];
-        [entireScissorDifference appendPath:subpathClippingResult.entireDifferencePath];
         
         // and track the segments for this subpath.
         // we'll update the segment intersections after this loop
@@ -1055,8 +1293,8 @@ static NSInteger segmentCompareCount = 0;
     }
     
     //
-    // at this point, we have the correct entireScissorIntersection and entireScissorDifference,
-    // and we can also map the subpath intersection objects to full path intersection objects.
+    // at this point, we have every subpath's segments, and we can
+    // map the subpath intersection objects to full path intersection objects.
     //
     // next, we need to update the segments so that each segment has the correct fullpath intersection
     // object to work with
@@ -1068,18 +1306,36 @@ static NSInteger segmentCompareCount = 0;
     // for their respective subpaths. we need to create new segment objects
     // to represent these segments that will adjust them into the full path's
     // list of intersections.
+    //
+    // segments almost always start and end at the exact intersection objects
+    // that we found for their subpath, so look those up by their identity
+    // instead of searching the whole list for each segment
+    NSMapTable* subpathIntersectionIndexes = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsObjectPointerPersonality
+                                                                   valueOptions:NSPointerFunctionsStrongMemory];
+    [allSubpathToShapeIntersections enumerateObjectsUsingBlock:^(id obj, NSUInteger idx, BOOL *stop) {
+        if(![subpathIntersectionIndexes objectForKey:obj]){
+            [subpathIntersectionIndexes setObject:@(idx) forKey:obj];
+        }
+    }];
+    NSUInteger (^indexOfSubpathIntersection)(DKUIBezierPathIntersectionPoint*) = ^NSUInteger(DKUIBezierPathIntersectionPoint* inter){
+        NSNumber* indx = [subpathIntersectionIndexes objectForKey:inter];
+        if(indx){
+            return [indx unsignedIntegerValue];
+        }
+        return [allSubpathToShapeIntersections indexOfObject:inter];
+    };
     void (^fixSegmentIntersections)(NSArray*, NSMutableArray*) = ^(NSArray* segmentsToFix, NSMutableArray* output) {
         for(DKUIBezierPathClippedSegment* seg in segmentsToFix){
             NSUInteger indx;
             DKUIBezierPathIntersectionPoint* correctedStartIntersection = seg.startIntersection;
-            indx = [allSubpathToShapeIntersections indexOfObject:seg.startIntersection];
+            indx = indexOfSubpathIntersection(seg.startIntersection);
             if(indx != NSNotFound){
                 // we found an intersection in the full scissor path that we can map to,
                 // so use that for the start
                 correctedStartIntersection = [scissorToShapeIntersections objectAtIndex:indx];
             }
             DKUIBezierPathIntersectionPoint* correctedEndIntersection = seg.endIntersection;
-            indx = [allSubpathToShapeIntersections indexOfObject:seg.endIntersection];
+            indx = indexOfSubpathIntersection(seg.endIntersection);
             if(indx != NSNotFound){
                 // we found an intersection in the full scissor path that we can map to,
                 // so use that for the end
@@ -1087,10 +1343,9 @@ static NSInteger segmentCompareCount = 0;
             }
             // now, create a new segment that is in relation to the full scissor path instead
             // of just the scissor subpath
-            DKUIBezierPathClippedSegment* correctedSeg = [DKUIBezierPathClippedSegment clippedPairWithStart:correctedStartIntersection
-                                                                                                     andEnd:correctedEndIntersection
-                                                                                             andPathSegment:seg.pathSegment
-                                                                                               fromFullPath:scissorPath];
+            DKUIBezierPathClippedSegment* correctedSeg = [seg segmentWithStart:correctedStartIntersection
+                                                                        andEnd:correctedEndIntersection
+                                                                  fromFullPath:scissorPath];
             [output addObject:correctedSeg];
         }
     };
@@ -1100,16 +1355,31 @@ static NSInteger segmentCompareCount = 0;
     fixSegmentIntersections(differenceSegments, correctedDifferenceSegments);
     
     // at this point, we have our full intersection information for the scissors.
-    // so we'll manually regenerate the full clipping result across all subpaths
-    DKUIBezierPathClippingResult* clipped1 = [[DKUIBezierPathClippingResult alloc] initWithIntersection:entireScissorIntersection
-                                                                                            andSegments:correctedIntersectionSegments
-                                                                                          andDifference:entireScissorDifference
-                                                                                            andSegments:correctedDifferenceSegments
-                                                                                    andShellIntSegments:numberOfShellIntersectionSegments
-                                                                                   andShellDiffSegments:numberOfShellDifferenceSegments];
+    // so we'll manually regenerate the full clipping result across all subpaths.
+    // its entire paths are each subpath's entire paths in order, and are
+    // only built if they're asked for
+    DKUIBezierPathClippingResult* clipped1 = [[DKUIBezierPathClippingResult alloc] initWithIntersectionSegments:correctedIntersectionSegments
+                                                                                        andDifferenceSegments:correctedDifferenceSegments
+                                                                                          andShellIntSegments:numberOfShellIntersectionSegments
+                                                                                         andShellDiffSegments:numberOfShellDifferenceSegments];
     return clipped1;
 }
 
+/**
+ * when set, the shape→scissor intersections that we derive from the
+ * scissor→shape intersections are also found the slow way, and an
+ * exception is thrown if the two disagree
+ */
+static std::atomic<bool> validatesDerivedIntersections(false);
+
++(void) setValidatesDerivedIntersections:(BOOL)validates{
+    validatesDerivedIntersections = validates;
+}
+
++(BOOL) validatesDerivedIntersections{
+    return validatesDerivedIntersections;
+}
+
 //
 // the scissor segments we'll call "red", and the shape segments we'll call "blue"
 //
@@ -1134,13 +1404,18 @@ static NSInteger segmentCompareCount = 0;
     // find the intersections between the two paths. these will be the definitive intersection points,
     // no matter which way we clip the paths later on. if we clip shape to scissors, or scissor to shape,
     // we'll use these same intersections (properly adjusted for each cut).
-    NSArray* scissorToShapeIntersections = [scissorPath findIntersectionsWithClosedPath:shapePath andBeginsInside:nil];
+    //
+    // every step below compares these same two paths, so
+    // work out each of their elements only once
+    DKPathElementTable scissorTable(scissorPath, kUIBezierClippingPrecision);
+    DKPathElementTable shapeTable(shapePath, kUIBezierClippingPrecision);
+    NSArray* scissorToShapeIntersections = [scissorPath findIntersectionsWithClosedPath:shapePath andBeginsInside:nil withTable:&scissorTable andClosedPathTable:&shapeTable];
     
     // so our first step is to create arrays of both the red and blue segments.
     //
     // first, find the red segments (scissor intersection with the shape), and connect
     // it's end to its start, if possible.
-    DKUIBezierPathClippingResult* clipped1 = [UIBezierPath redAndGreenSegmentsCreatedFrom:shapePath bySlicingWithPath:scissorPath withIntersections:scissorToShapeIntersections];
+    DKUIBezierPathClippingResult* clipped1 = [UIBezierPath redAndGreenSegmentsCreatedFrom:shapePath bySlicingWithPath:scissorPath withIntersections:scissorToShapeIntersections andShapeTable:&shapeTable andScissorTable:&scissorTable];
     NSMutableArray* redSegments = [NSMutableArray arrayWithArray:clipped1.intersectionSegments];
     NSMutableArray* greenSegments = [NSMutableArray arrayWithArray:clipped1.differenceSegments];
     
@@ -1155,17 +1430,17 @@ static NSInteger segmentCompareCount = 0;
     // 2. sort them so that they match the order we would have got if we'd found new intersections
     // 3. reset the mayCrossBoundary flag to match the path order we're cutting with
     
-    // just find if it begins inside, but we'll throw away the intersections for now,
-    // because we're going to reuse and resort the tValuesOfIntersectionPoints1.
-    // this solves rounding error that happens when intersections generate slightly differently
-    // depending on the order of paths sent in
-    NSArray* intersectionsWithBoundaryInformation = [shapePath findIntersectionsWithClosedPath:scissorPath andBeginsInside:nil];
     //
     // this array will be the intersections between the shape and the scissor.
     // we'll use the exact same intersection objects (flipped, b/c we're attacking from
     // the shape v scissor instead of vice versa). We'll need to order them and
     // set the mayCrossBoundary so that the final array will appear as if it came
     // directly from [shapePath findIntersectionsWithClosedPath:scissorPath...]
+    //
+    // reusing them instead of finding them again saves solving every pair of
+    // elements a second time, and also solves rounding error that happens when
+    // intersections generate slightly differently depending on the order of
+    // paths sent in
     NSMutableArray* shapeToScissorIntersections = [NSMutableArray array];
     // 1. flip
     [scissorToShapeIntersections enumerateObjectsUsingBlock:^(id obj, NSUInteger idx, BOOL *stop){
@@ -1181,18 +1456,31 @@ static NSInteger segmentCompareCount = 0;
         }
         return NSOrderedDescending;
     }];
+    // 3. fix mayCrossBoundary, walking along the shape instead of the scissor
+    [shapePath markBoundaryCrossingsOfIntersections:shapeToScissorIntersections withClosedPath:scissorPath andBeginsInside:nil];
     
-    if([shapeToScissorIntersections count] != [intersectionsWithBoundaryInformation count]){
-        @throw [NSException exceptionWithName:@"BezierPathIntersectionException" reason:@"mismatched intersection length" userInfo:nil];
-    }
-    // 3. fix mayCrossBoundary:
-    for(int i=0;i<[intersectionsWithBoundaryInformation count];i++){
-        [[shapeToScissorIntersections objectAtIndex:i] setMayCrossBoundary:[[intersectionsWithBoundaryInformation objectAtIndex:i] mayCrossBoundary]];
+    if(validatesDerivedIntersections){
+        NSArray* intersectionsWithBoundaryInformation = [shapePath findIntersectionsWithClosedPath:scissorPath andBeginsInside:nil withTable:&shapeTable andClosedPathTable:&scissorTable];
+        if([shapeToScissorIntersections count] != [intersectionsWithBoundaryInformation count]){
+            @throw [NSException exceptionWithName:@"BezierPathIntersectionException" reason:@"mismatched intersection length" userInfo:nil];
+        }
+        for(int i=0;i<[intersectionsWithBoundaryInformation count];i++){
+            DKUIBezierPathIntersectionPoint* derived = [shapeToScissorIntersections objectAtIndex:i];
+            DKUIBezierPathIntersectionPoint* found = [intersectionsWithBoundaryInformation objectAtIndex:i];
+            CGPoint derivedLoc = [derived location1];
+            CGPoint foundLoc = [found location1];
+            if(derived.elementIndex1 != found.elementIndex1 ||
+               ABS(derivedLoc.x - foundLoc.x) > kUIBezierClosenessPrecision ||
+               ABS(derivedLoc.y - foundLoc.y) > kUIBezierClosenessPrecision ||
+               derived.mayCrossBoundary != found.mayCrossBoundary){
+                @throw [NSException exceptionWithName:@"BezierPathIntersectionException" reason:@"mismatched derived intersection" userInfo:nil];
+            }
+        }
     }
     
     //
     // now we can clip the shape and scissor with essentially the same intersection points
-    DKUIBezierPathClippingResult* clipped2 = [UIBezierPath redAndGreenSegmentsCreatedFrom:scissorPath bySlicingWithPath:shapePath withIntersections:shapeToScissorIntersections];
+    DKUIBezierPathClippingResult* clipped2 = [UIBezierPath redAndGreenSegmentsCreatedFrom:scissorPath bySlicingWithPath:shapePath withIntersections:shapeToScissorIntersections andShapeTable:&scissorTable andScissorTable:&shapeTable];
     
     //
     // this output (clipped1 and clipped2) give us the Segment objects for both the scissors and
@@ -1296,13 +1584,7 @@ static NSInteger segmentCompareCount = 0;
                 if([possibleMatchedBlueSeg.startIntersection isEqualToIntersection:currBlueSeg.endIntersection] &&
                    possibleMatchedBlueSeg != currBlueSeg){
                     // merge the two segments
-                    UIBezierPath* newPathSegment = currBlueSeg.pathSegment;
-                    [newPathSegment appendPathRemovingInitialMoveToPoint:possibleMatchedBlueSeg.pathSegment];
-                    
-                    DKUIBezierPathClippedSegment* newBlueSeg = [DKUIBezierPathClippedSegment clippedPairWithStart:currBlueSeg.startIntersection
-                                                                                                           andEnd:possibleMatchedBlueSeg.endIntersection
-                                                                                                   andPathSegment:newPathSegment
-                                                                                                     fromFullPath:currBlueSeg.fullPath];
+                    DKUIBezierPathClippedSegment* newBlueSeg = [currBlueSeg prependTo:possibleMatchedBlueSeg];
                     [blueSegments replaceObjectAtIndex:i withObject:newBlueSeg];
                     [blueSegments removeObject:possibleMatchedBlueSeg];
                     if(numberOfBlueShellSegments){
@@ -1363,6 +1645,15 @@ static NSInteger segmentCompareCount = 0;
  * returns only unique subshapes, removing duplicates
  */
 -(NSArray*) uniqueShapeShellsAndSubshapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath{
+    return [self uniqueShapeShellsAndSubshapesCreatedFromSlicingWithUnclosedPath:scissorPath withMinimumArea:0];
+}
+
+/**
+ * returns only unique subshapes that have at least minimumArea,
+ * removing duplicates. slivers are dropped before they're compared,
+ * so they never cost a pass through the duplicate check
+ */
+-(NSArray*) uniqueShapeShellsAndSubshapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath withMinimumArea:(CGFloat)minimumArea{
     NSArray* shapeShellsAndSubShapes = [self shapeShellsAndSubshapesCreatedFromSlicingWithUnclosedPath:scissorPath];
     NSArray* shapeShells = [shapeShellsAndSubShapes firstObject];
     NSArray* subShapes = [shapeShellsAndSubShapes lastObject];
@@ -1370,8 +1661,13 @@ static NSInteger segmentCompareCount = 0;
     NSArray* (^deduplicateShapes)(NSArray*inter) = ^NSArray*(NSArray* shapes){
         NSMutableArray* uniquePaths = [NSMutableArray array];
         for(DKUIBezierPathShape* possibleDuplicate in shapes){
+            throwIfClippingCancelled();
             if([possibleDuplicate isClosed]){
                 // ignore unclosed shapes
+                if(minimumArea > 0 && ABS([possibleDuplicate signedArea]) < minimumArea){
+                    // ignore slivers
+                    continue;
+                }
                 BOOL foundDuplicate = NO;
                 for(DKUIBezierPathShape* uniqueShape in uniquePaths){
                     if([uniqueShape isSameShapeAs:possibleDuplicate]){
@@ -1399,7 +1695,11 @@ static NSInteger segmentCompareCount = 0;
  * returns only unique subshapes, removing duplicates
  */
 -(NSArray*) uniqueShapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath{
-    NSArray* shapeShellsAndSubShapes = [self uniqueShapeShellsAndSubshapesCreatedFromSlicingWithUnclosedPath:scissorPath];
+    return [self uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withMinimumArea:0];
+}
+
+-(NSArray*) uniqueShapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath withMinimumArea:(CGFloat)minimumArea{
+    NSArray* shapeShellsAndSubShapes = [self uniqueShapeShellsAndSubshapesCreatedFromSlicingWithUnclosedPath:scissorPath withMinimumArea:minimumArea];
     NSArray* shapeShells = [shapeShellsAndSubShapes firstObject];
     NSArray* subShapes = [shapeShellsAndSubShapes lastObject];
 
@@ -1469,6 +1769,7 @@ static NSInteger segmentCompareCount = 0;
     // only the tangent and same-directioned red segment.
     
     for(DKUIBezierPathClippedSegment* red in _redSegments){
+        throwIfClippingCancelled();
         BOOL shouldAdd = YES;
         for(DKUIBezierPathClippedSegment* blue in _blueSegments){
             DKUIBezierPathClippedSegment* flippedBlue = [blue flippedRedBlueSegment];
@@ -1505,6 +1806,7 @@ static NSInteger segmentCompareCount = 0;
     
     
     for(DKUIBezierPathClippedSegment* blue in _blueSegments){
+        throwIfClippingCancelled();
         BOOL shouldAdd = YES;
         for(DKUIBezierPathClippedSegment* red in _redSegments){
             DKUIBezierPathClippedSegment* flippedBlue = [blue flippedRedBlueSegment];
@@ -1546,6 +1848,7 @@ static NSInteger segmentCompareCount = 0;
     
     
     while([redSegmentsToStartWith count] || [allUnusedBlueSegments count]){
+        throwIfClippingCancelled();
         BOOL failedBuildingShape = NO;
         DKUIBezierPathClippedSegment* startingSegment;
         BOOL startedWithRed;
@@ -1639,25 +1942,25 @@ static NSInteger segmentCompareCount = 0;
             DKUIBezierPathClippedSegment* blueSeg = [blueSegmentsLeftToUse objectAtIndex:bi];
             if([blueSeg.startIntersection crossMatchesIntersection:[segment endIntersection]]){
                 if(!currentSegmentCandidate){
-                    DKVector* currSeg = [[segment pathSegment] tangentNearEnd].tangent;
-                    DKVector* currPoss = [[blueSeg pathSegment] tangentNearStart].tangent;
-                    //                        NSLog(@"angle: %f", [currSeg angleBetween:currPoss]);
-                    if([UIBezierPath round:[currSeg angleBetween:currPoss] to:6] == [UIBezierPath round:M_PI to:6]){
+                    DKVectorValue currSeg = [segment endTangent];
+                    DKVectorValue currPoss = [blueSeg startTangent];
+                    //                        NSLog(@"angle: %f", currSeg.angleBetween(currPoss));
+                    if([UIBezierPath round:currSeg.angleBetween(currPoss) to:6] == [UIBezierPath round:M_PI to:6]){
                         // never allow exactly backwards tangents
-                    }else if([UIBezierPath round:[currSeg angleBetween:currPoss] to:6] == [UIBezierPath round:-M_PI to:6]){
+                    }else if([UIBezierPath round:currSeg.angleBetween(currPoss) to:6] == [UIBezierPath round:-M_PI to:6]){
                         // never allow exactly backwards tangents
                     }else{
                         currentSegmentCandidate = blueSeg;
                         lastWasRed = NO;
                     }
                 }else{
-                    DKVector* currSeg = [[segment pathSegment] tangentNearEnd].tangent;
-                    DKVector* currPoss = [[currentSegmentCandidate pathSegment] tangentNearStart].tangent;
-                    DKVector* newPoss = [[blueSeg pathSegment] tangentNearStart].tangent;
-                    //                        NSLog(@"angle: %f vs %f", [currSeg angleBetween:currPoss], [currSeg angleBetween:newPoss]);
+                    DKVectorValue currSeg = [segment endTangent];
+                    DKVectorValue currPoss = [currentSegmentCandidate startTangent];
+                    DKVectorValue newPoss = [blueSeg startTangent];
+                    //                        NSLog(@"angle: %f vs %f", currSeg.angleBetween(currPoss), currSeg.angleBetween(newPoss));
                     if(gt){
-                        if([currSeg angleBetween:newPoss] > [currSeg angleBetween:currPoss]){
-                            if([UIBezierPath round:[currSeg angleBetween:newPoss] to:3] == [UIBezierPath round:M_PI to:3]){
+                        if(currSeg.angleBetween(newPoss) > currSeg.angleBetween(currPoss)){
+                            if([UIBezierPath round:currSeg.angleBetween(newPoss) to:3] == [UIBezierPath round:M_PI to:3]){
                                 // never allow exactly backwards tangents
                             }else{
                                 currentSegmentCandidate = blueSeg;
@@ -1665,8 +1968,8 @@ static NSInteger segmentCompareCount = 0;
                             }
                         }
                     }else{
-                        if([currSeg angleBetween:newPoss] < [currSeg angleBetween:currPoss]){
-                            if([UIBezierPath round:[currSeg angleBetween:newPoss] to:3] == [UIBezierPath round:-M_PI to:3]){
+                        if(currSeg.angleBetween(newPoss) < currSeg.angleBetween(currPoss)){
+                            if([UIBezierPath round:currSeg.angleBetween(newPoss) to:3] == [UIBezierPath round:-M_PI to:3]){
                                 // never allow exactly backwards tangents
                             }else{
                                 currentSegmentCandidate = blueSeg;
@@ -1690,24 +1993,24 @@ static NSInteger segmentCompareCount = 0;
         DKUIBezierPathClippedSegment* lastSegmentInShapeAsBlue = [segment flippedRedBlueSegment];
         if([redSeg.startIntersection crossMatchesIntersection:[lastSegmentInShapeAsBlue endIntersection]]){
             if(!currentSegmentCandidate){
-                DKVector* currSeg = [[segment pathSegment] tangentNearEnd].tangent;
-                DKVector* currPoss = [[redSeg pathSegment] tangentNearStart].tangent;
-                //                    NSLog(@"angle: %f", [currSeg angleBetween:currPoss]);
-                if([UIBezierPath round:[currSeg angleBetween:currPoss] to:6] == [UIBezierPath round:M_PI to:6]){
+                DKVectorValue currSeg = [segment endTangent];
+                DKVectorValue currPoss = [redSeg startTangent];
+                //                    NSLog(@"angle: %f", currSeg.angleBetween(currPoss));
+                if([UIBezierPath round:currSeg.angleBetween(currPoss) to:6] == [UIBezierPath round:M_PI to:6]){
                     // never allow exactly backwards tangents
-                }else if([UIBezierPath round:[currSeg angleBetween:currPoss] to:6] == [UIBezierPath round:-M_PI to:6]){
+                }else if([UIBezierPath round:currSeg.angleBetween(currPoss) to:6] == [UIBezierPath round:-M_PI to:6]){
                     // never allow exactly backwards tangents
                 }else{
                     currentSegmentCandidate = redSeg;
                     lastWasRed = YES;
                 }
             }else{
-                DKVector* currSeg = [[segment pathSegment] tangentNearEnd].tangent;
-                DKVector* currPoss = [[currentSegmentCandidate pathSegment] tangentNearStart].tangent;
-                DKVector* newPoss = [[redSeg pathSegment] tangentNearStart].tangent;
+                DKVectorValue currSeg = [segment endTangent];
+                DKVectorValue currPoss = [currentSegmentCandidate startTangent];
+                DKVectorValue newPoss = [redSeg startTangent];
                 if(gt){
-                    if([currSeg angleBetween:newPoss] >= [currSeg angleBetween:currPoss]){
-                        if([UIBezierPath round:[currSeg angleBetween:newPoss] to:3] == [UIBezierPath round:M_PI to:3]){
+                    if(currSeg.angleBetween(newPoss) >= currSeg.angleBetween(currPoss)){
+                        if([UIBezierPath round:currSeg.angleBetween(newPoss) to:3] == [UIBezierPath round:M_PI to:3]){
                             // never allow exactly backwards tangents
                         }else{
                             currentSegmentCandidate = redSeg;
@@ -1715,8 +2018,8 @@ static NSInteger segmentCompareCount = 0;
                         }
                     }
                 }else{
-                    if([currSeg angleBetween:newPoss] <= [currSeg angleBetween:currPoss]){
-                        if([UIBezierPath round:[currSeg angleBetween:newPoss] to:3] == [UIBezierPath round:-M_PI to:3]){
+                    if(currSeg.angleBetween(newPoss) <= currSeg.angleBetween(currPoss)){
+                        if([UIBezierPath round:currSeg.angleBetween(newPoss) to:3] == [UIBezierPath round:-M_PI to:3]){
                             // never allow exactly backwards tangents
                         }else{
                             currentSegmentCandidate = redSeg;
@@ -1744,6 +2047,417 @@ static NSInteger segmentCompareCount = 0;
     return clipped.entireDifferencePath;
 }
 
+#pragma mark - Clipping Options
+
+/**
+ * returns self, or a simplified copy of self if
+ * the options have a simplification tolerance
+ */
+-(UIBezierPath*) bezierPathPreparedForClippingWithOptions:(DKUIBezierPathClippingOptions*)options{
+    return [self bezierPathPreparedForClippingWithOptions:options elementMapping:nil];
+}
+
+/**
+ * the same as above, and fills in the elementMapping from the
+ * returned path's elements to self's, if it's non-nil. when self
+ * is returned, each element maps to itself
+ */
+-(UIBezierPath*) bezierPathPreparedForClippingWithOptions:(DKUIBezierPathClippingOptions*)options elementMapping:(NSArray**)elementMapping{
+    if(options.simplificationTolerance > 0){
+        return [self bezierPathBySimplifyingWithTolerance:options.simplificationTolerance
+                                           andCornerAngle:options.simplificationCornerAngle
+                                           elementMapping:elementMapping];
+    }
+    if(elementMapping){
+        NSMutableArray* mapping = [NSMutableArray arrayWithCapacity:[self elementCount]];
+        for(NSInteger i=0;i<[self elementCount];i++){
+            [mapping addObject:[NSValue valueWithRange:NSMakeRange(i, 1)]];
+        }
+        *elementMapping = mapping;
+    }
+    return self;
+}
+
+-(NSArray*) uniqueShapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath withOptions:(DKUIBezierPathClippingOptions*)options{
+    return [self uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withOptions:options shapeElementMapping:nil andScissorElementMapping:nil];
+}
+
+-(NSArray*) uniqueShapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath
+                                               withOptions:(DKUIBezierPathClippingOptions*)options
+                                       shapeElementMapping:(NSArray**)shapeElementMapping
+                                  andScissorElementMapping:(NSArray**)scissorElementMapping{
+    UIBezierPath* shapePath = [self bezierPathPreparedForClippingWithOptions:options elementMapping:shapeElementMapping];
+    scissorPath = [scissorPath bezierPathPreparedForClippingWithOptions:options elementMapping:scissorElementMapping];
+    return [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withMinimumArea:options.minimumArea];
+}
+
+-(DKUIBezierPathClippingResult*) clipToClosedPath:(UIBezierPath*)closedPath withOptions:(DKUIBezierPathClippingOptions*)options{
+    return [self clipToClosedPath:closedPath withOptions:options elementMapping:nil andClosedPathElementMapping:nil];
+}
+
+-(DKUIBezierPathClippingResult*) clipToClosedPath:(UIBezierPath*)closedPath
+                                      withOptions:(DKUIBezierPathClippingOptions*)options
+                                   elementMapping:(NSArray**)elementMapping
+                      andClosedPathElementMapping:(NSArray**)closedPathElementMapping{
+    UIBezierPath* unclosedPath = [self bezierPathPreparedForClippingWithOptions:options elementMapping:elementMapping];
+    closedPath = [closedPath bezierPathPreparedForClippingWithOptions:options elementMapping:closedPathElementMapping];
+    NSArray* intersections = [unclosedPath findIntersectionsWithClosedPath:closedPath andBeginsInside:nil];
+    // this handles an unclosedPath with multiple subpaths,
+    // unlike clipUnclosedPathToClosedPath:
+    return [UIBezierPath redAndGreenSegmentsCreatedFrom:closedPath bySlicingWithPath:unclosedPath withIntersections:intersections];
+}
+
+
+#pragma mark - Rectangle Clipping
+
+/**
+ * the closed path that clipToRect: clips to. its elements are always
+ * the move to the top left corner, then lines along the top, right,
+ * and bottom edges, and a close along the left edge.
+ */
++(UIBezierPath*) bezierPathForClippingToRect:(CGRect)rect{
+    UIBezierPath* rectPath = [UIBezierPath bezierPath];
+    [rectPath moveToPoint:CGPointMake(CGRectGetMinX(rect), CGRectGetMinY(rect))];
+    [rectPath addLineToPoint:CGPointMake(CGRectGetMaxX(rect), CGRectGetMinY(rect))];
+    [rectPath addLineToPoint:CGPointMake(CGRectGetMaxX(rect), CGRectGetMaxY(rect))];
+    [rectPath addLineToPoint:CGPointMake(CGRectGetMinX(rect), CGRectGetMaxY(rect))];
+    [rectPath closePath];
+    return rectPath;
+}
+
+/**
+ * the same as findIntersectionsWithClosedPath:andBeginsInside:, when
+ * the closed path is the rectPath made for the rect. each element is
+ * solved against the line of each edge directly, and whether we're
+ * inside the rect is only ever a comparison of coordinates.
+ */
+-(NSArray*) findIntersectionsWithRect:(CGRect)rect ofPath:(UIBezierPath*)rectPath andBeginsInside:(BOOL*)beginsInside{
+    NSMutableArray* foundIntersections = [NSMutableArray array];
+    
+    DKPathElementTable selfTable(self, kUIBezierClippingPrecision);
+    DKPathElementTable rectTable(rectPath, kUIBezierClippingPrecision);
+    NSInteger elementCount1 = [self elementCount];
+    NSInteger elementCount2 = [rectPath elementCount];
+    // expand the bounds by 1px, just so we're sure to see overlapping bounds for tangent paths
+    CGRect paddedRect = CGRectInset(rect, -1, -1);
+    
+    CGFloat selfLengthBeforeElement = 0;
+    for(NSInteger selfElementIndex = 0; selfElementIndex < selfTable.count(); selfElementIndex++){
+        const DKPathElement& selfElement = selfTable[selfElementIndex];
+        if(selfElement.type != kCGPathElementMoveToPoint &&
+           CGRectIntersectsRect(CGRectInset(selfElement.bounds, -1, -1), paddedRect)){
+            CGFloat rectLengthBeforeEdge = 0;
+            for(NSInteger edgeIndex = 1; edgeIndex < rectTable.count(); edgeIndex++){
+                const DKPathElement& edge = rectTable[edgeIndex];
+                // the right and left edges are vertical, and
+                // the top and bottom are horizontal
+                BOOL isVertical = edgeIndex % 2 == 0;
+                CGFloat roots[3];
+                NSInteger rootCount;
+                if(isVertical){
+                    rootCount = DKRootsOfBezierAxisAtValue(selfElement.bez[0].x, selfElement.bez[1].x, selfElement.bez[2].x, selfElement.bez[3].x, edge.bez[0].x, kUIBezierClippingPrecision, roots);
+                }else{
+                    rootCount = DKRootsOfBezierAxisAtValue(selfElement.bez[0].y, selfElement.bez[1].y, selfElement.bez[2].y, selfElement.bez[3].y, edge.bez[0].y, kUIBezierClippingPrecision, roots);
+                }
+                for(NSInteger i = 0; i < rootCount; i++){
+                    CGPoint location = [UIBezierPath pointAtT:roots[i] forBezier:(CGPoint*)selfElement.bez];
+                    CGFloat edgeStart = isVertical ? edge.bez[0].y : edge.bez[0].x;
+                    CGFloat edgeEnd = isVertical ? edge.bez[3].y : edge.bez[3].x;
+                    CGFloat locationAlongEdge = isVertical ? location.y : location.x;
+                    CGFloat edgeTValue = (edgeEnd == edgeStart) ? 0 : (locationAlongEdge - edgeStart) / (edgeEnd - edgeStart);
+                    if(edgeTValue < -kUIBezierClippingPrecision || edgeTValue > 1 + kUIBezierClippingPrecision){
+                        // the element crosses the edge's line outside of the rect
+                        continue;
+                    }
+                    edgeTValue = MAX(0.0, MIN(1.0, edgeTValue));
+                    
+                    DKUIBezierPathIntersectionPoint* inter = [DKUIBezierPathIntersectionPoint intersectionAtElementIndex:selfElementIndex
+                                                                                                               andTValue:roots[i]
+                                                                                                        withElementIndex:edgeIndex
+                                                                                                               andTValue:edgeTValue
+                                                                                                        andElementCount1:elementCount1
+                                                                                                        andElementCount2:elementCount2
+                                                                                                  andLengthUntilPath1Loc:selfLengthBeforeElement + roots[i] * selfElement.length
+                                                                                                  andLengthUntilPath2Loc:rectLengthBeforeEdge + edgeTValue * edge.length];
+                    for(int j = 0; j < 4; j++){
+                        inter.bez1[j] = selfElement.bez[j];
+                        inter.bez2[j] = edge.bez[j];
+                    }
+                    inter.pathLength1 = selfTable.length();
+                    inter.pathLength2 = rectTable.length();
+                    [foundIntersections addObject:inter];
+                }
+                rectLengthBeforeEdge += edge.length;
+            }
+        }
+        selfLengthBeforeElement += selfElement.length;
+    }
+    
+    [foundIntersections sortUsingComparator:^NSComparisonResult(id obj1, id obj2){
+        if([obj1 elementIndex1] < [obj2 elementIndex1]){
+            return NSOrderedAscending;
+        }else if([obj1 elementIndex1] == [obj2 elementIndex1] &&
+                 [obj1 tValue1] < [obj2 tValue1]){
+            return NSOrderedAscending;
+        }
+        return NSOrderedDescending;
+    }];
+    
+    // an element through a corner crosses both of its edges at once
+    foundIntersections = [UIBezierPath distinctIntersectionsFrom:foundIntersections];
+    
+    // points on the edges count as inside, the same as containsPoint: would
+    [self markBoundaryCrossingsOfIntersections:foundIntersections withContainment:^BOOL(CGPoint point){
+        return point.x >= CGRectGetMinX(rect) && point.x <= CGRectGetMaxX(rect) &&
+        point.y >= CGRectGetMinY(rect) && point.y <= CGRectGetMaxY(rect);
+    } andBeginsInside:beginsInside];
+    
+    [DKUIBezierPathIntersectionPoint assignIdsToIntersections:foundIntersections];
+    
+    return [foundIntersections copy];
+}
+
+-(DKUIBezierPathClippingResult*) clipToRect:(CGRect)rect{
+    rect = CGRectStandardize(rect);
+    UIBezierPath* rectPath = [UIBezierPath bezierPathForClippingToRect:rect];
+    BOOL beginsInside = NO;
+    NSArray* intersections = [self findIntersectionsWithRect:rect ofPath:rectPath andBeginsInside:&beginsInside];
+    NSInteger elementCount = [self elementCount];
+    return [UIBezierPath redAndGreenSegmentsCreatedFrom:rectPath bySlicingWithPath:self withIntersections:intersections usingSubpathIntersections:^NSArray*(UIBezierPath* subScissors, BOOL* subpathBeginsInside){
+        if([subScissors elementCount] == elementCount){
+            // self is only a single subpath, so we already have its intersections
+            *subpathBeginsInside = beginsInside;
+            return intersections;
+        }
+        return [subScissors findIntersectionsWithRect:rect ofPath:rectPath andBeginsInside:subpathBeginsInside];
+    }];
+}
+
+
+#pragma mark - Path Distance
+
+-(CGFloat) closestDistanceToPath:(UIBezierPath*)otherPath atIndex:(NSInteger*)elementIndex andElementTValue:(CGFloat*)tValue otherIndex:(NSInteger*)otherElementIndex andOtherElementTValue:(CGFloat*)otherTValue{
+    DKPathElementTable table1(self);
+    DKPathElementTable table2(otherPath);
+    DKPathElementTree tree1(table1);
+    DKPathElementTree tree2(table2);
+    DKClosestElementPoints closest;
+    DKClosestPointsOfTrees(tree1, tree2, kUIBezierDistancePrecision, -1, &closest);
+    if(elementIndex) elementIndex[0] = closest.elementIndex1;
+    if(tValue) tValue[0] = closest.tValue1;
+    if(otherElementIndex) otherElementIndex[0] = closest.elementIndex2;
+    if(otherTValue) otherTValue[0] = closest.tValue2;
+    return closest.distance;
+}
+
+-(BOOL) isWithinDistance:(CGFloat)radius ofPath:(UIBezierPath*)otherPath{
+    if(radius < 0){
+        return NO;
+    }
+    DKPathElementTable table1(self);
+    DKPathElementTable table2(otherPath);
+    DKPathElementTree tree1(table1);
+    DKPathElementTree tree2(table2);
+    return DKClosestPointsOfTrees(tree1, tree2, kUIBezierDistancePrecision, radius, NULL);
+}
+
+
+#pragma mark - Time Budgeted Clipping
+
+/**
+ * runs the work, and returns its result, or nil if it didn't finish
+ * before the deadline. a deadline from an outer call is kept if it's
+ * sooner, and a cancelled operation still unwinds out of here.
+ */
++(id) runClippingWork:(id (^)(void))work beforeDeadline:(CFAbsoluteTime)deadline{
+    CFAbsoluteTime previousDeadline = currentClippingDeadline;
+    currentClippingDeadline = previousDeadline ? MIN(previousDeadline, deadline) : deadline;
+    __block id result = nil;
+    @autoreleasepool {
+        @try{
+            result = work();
+        }@catch(NSException* e){
+            if(![[e name] isEqualToString:DKUIBezierPathClippingCancelledException] ||
+               (currentClippingOperation && currentClippingOperation.isCancelled)){
+                currentClippingDeadline = previousDeadline;
+                @throw;
+            }
+            result = nil;
+        }
+    }
+    currentClippingDeadline = previousDeadline;
+    return result;
+}
+
+/**
+ * the distance from the point to the nearest point
+ * on the line segment from start to end
+ */
+static CGFloat distanceToLineSegment(CGPoint point, CGPoint start, CGPoint end){
+    CGPoint direction = CGPointMake(end.x - start.x, end.y - start.y);
+    CGFloat lengthSquared = direction.x * direction.x + direction.y * direction.y;
+    CGFloat t = 0;
+    if(lengthSquared > 0){
+        t = ((point.x - start.x) * direction.x + (point.y - start.y) * direction.y) / lengthSquared;
+        t = MAX(0, MIN(1, t));
+    }
+    return distance(point, CGPointMake(start.x + direction.x * t, start.y + direction.y * t));
+}
+
+/**
+ * adds lines to the path that follow the bezier to within flatness.
+ * the curve stays inside the hull of its control points, so once
+ * both control points are within flatness of the chord, so is
+ * the whole curve. otherwise it's split in half and tried again
+ */
+static void addFlattenedBezier(UIBezierPath* path, CGPoint* bez, CGFloat flatness, NSInteger depth){
+    if(depth >= 16 ||
+       MAX(distanceToLineSegment(bez[1], bez[0], bez[3]), distanceToLineSegment(bez[2], bez[0], bez[3])) <= flatness){
+        [path addLineToPoint:bez[3]];
+        return;
+    }
+    CGPoint left[4], right[4];
+    [UIBezierPath subdivideBezier:bez intoLeft:left andRight:right atT:0.5];
+    addFlattenedBezier(path, left, flatness, depth + 1);
+    addFlattenedBezier(path, right, flatness, depth + 1);
+}
+
+/**
+ * the coarse tier clips copies of the paths with their curves
+ * flattened to kUIBezierCoarseFlatness, which is much looser than
+ * bezierPathByFlatteningPath, so there are far fewer lines to
+ * compare, and they only ever need line to line intersections
+ */
+-(UIBezierPath*) bezierPathPreparedForCoarseClippingWithOptions:(DKUIBezierPathClippingOptions*)options{
+    UIBezierPath* preparedPath = [self bezierPathPreparedForClippingWithOptions:options];
+    UIBezierPath* coarsePath = [UIBezierPath bezierPath];
+    __block CGPoint lastPoint = CGPointZero;
+    __block CGPoint subpathStartingPoint = CGPointZero;
+    [preparedPath iteratePathWithBlock:^(CGPathElement element, NSUInteger idx){
+        CGPoint bez[4];
+        CGPoint endPoint = [UIBezierPath fillCGPoints:bez withElement:element givenElementStartingPoint:lastPoint andSubPathStartingPoint:subpathStartingPoint];
+        if(element.type == kCGPathElementMoveToPoint){
+            [coarsePath moveToPoint:endPoint];
+            subpathStartingPoint = endPoint;
+        }else if(element.type == kCGPathElementCloseSubpath){
+            [coarsePath closePath];
+        }else if(element.type == kCGPathElementAddLineToPoint){
+            [coarsePath addLineToPoint:endPoint];
+        }else{
+            addFlattenedBezier(coarsePath, bez, kUIBezierCoarseFlatness, 0);
+        }
+        lastPoint = endPoint;
+    }];
+    return coarsePath;
+}
+
+-(NSArray*) uniqueShapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath withOptions:(DKUIBezierPathClippingOptions*)options deadline:(CFAbsoluteTime)deadline tier:(DKUIBezierPathClippingTier*)tier{
+    UIBezierPath* coarseShapePath = [self bezierPathPreparedForCoarseClippingWithOptions:options];
+    UIBezierPath* coarseScissorPath = [scissorPath bezierPathPreparedForCoarseClippingWithOptions:options];
+    NSArray* shapes = [coarseShapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:coarseScissorPath withMinimumArea:options.minimumArea];
+    DKUIBezierPathClippingTier resultTier = DKUIBezierPathClippingTierCoarse;
+    
+    if(CFAbsoluteTimeGetCurrent() < deadline){
+        NSArray* fullShapes = [UIBezierPath runClippingWork:^id{
+            return [self uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withOptions:options];
+        } beforeDeadline:deadline];
+        if(fullShapes){
+            shapes = fullShapes;
+            resultTier = DKUIBezierPathClippingTierFull;
+        }
+    }
+    if(tier){
+        *tier = resultTier;
+    }
+    return shapes;
+}
+
+-(DKUIBezierPathClippingResult*) clipToClosedPath:(UIBezierPath*)closedPath withOptions:(DKUIBezierPathClippingOptions*)options deadline:(CFAbsoluteTime)deadline tier:(DKUIBezierPathClippingTier*)tier{
+    UIBezierPath* coarseUnclosedPath = [self bezierPathPreparedForCoarseClippingWithOptions:options];
+    UIBezierPath* coarseClosedPath = [closedPath bezierPathPreparedForCoarseClippingWithOptions:options];
+    DKUIBezierPathClippingResult* result = [coarseUnclosedPath clipToClosedPath:coarseClosedPath withOptions:nil];
+    DKUIBezierPathClippingTier resultTier = DKUIBezierPathClippingTierCoarse;
+    
+    if(CFAbsoluteTimeGetCurrent() < deadline){
+        DKUIBezierPathClippingResult* fullResult = [UIBezierPath runClippingWork:^id{
+            return [self clipToClosedPath:closedPath withOptions:options];
+        } beforeDeadline:deadline];
+        if(fullResult){
+            result = fullResult;
+            resultTier = DKUIBezierPathClippingTierFull;
+        }
+    }
+    if(tier){
+        *tier = resultTier;
+    }
+    return result;
+}
+
+
+#pragma mark - Asynchronous Clipping
+
+/**
+ * runs the work on a background queue for the operation, and calls
+ * the completion on the main queue with its result unless the
+ * operation was cancelled first. only the cancellation exception
+ * is caught here, anything else the work throws is a real failure
+ * and is rethrown
+ */
++(void) runClippingOperation:(DKUIBezierPathClippingOperation*)operation withWork:(id (^)(void))work andCompletion:(void (^)(id result))completion{
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        if(operation.isCancelled){
+            return;
+        }
+        __block id result = nil;
+        // anything the work autoreleased is released here,
+        // whether it finished or was cancelled part way through
+        @autoreleasepool {
+            currentClippingOperation = operation;
+            @try{
+                result = work();
+            }@catch(NSException* e){
+                currentClippingOperation = nil;
+                if(![[e name] isEqualToString:DKUIBezierPathClippingCancelledException]){
+                    @throw;
+                }
+            }
+            currentClippingOperation = nil;
+        }
+        if(operation.isCancelled){
+            return;
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if(!operation.isCancelled && completion){
+                completion(result);
+            }
+        });
+    });
+}
+
+-(DKUIBezierPathClippingOperation*) uniqueShapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath withOptions:(DKUIBezierPathClippingOptions*)options completion:(void (^)(NSArray* shapes))completion{
+    DKUIBezierPathClippingOperation* operation = [[DKUIBezierPathClippingOperation alloc] init];
+    // copy everything, so the caller is free to keep
+    // changing their paths while we work
+    UIBezierPath* shapePath = [self copy];
+    scissorPath = [scissorPath copy];
+    options = [options copy];
+    [UIBezierPath runClippingOperation:operation withWork:^id{
+        return [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withOptions:options];
+    } andCompletion:completion];
+    return operation;
+}
+
+-(DKUIBezierPathClippingOperation*) clipToClosedPath:(UIBezierPath*)closedPath withOptions:(DKUIBezierPathClippingOptions*)options completion:(void (^)(DKUIBezierPathClippingResult* result))completion{
+    DKUIBezierPathClippingOperation* operation = [[DKUIBezierPathClippingOperation alloc] init];
+    UIBezierPath* unclosedPath = [self copy];
+    closedPath = [closedPath copy];
+    options = [options copy];
+    [UIBezierPath runClippingOperation:operation withWork:^id{
+        return [unclosedPath clipToClosedPath:closedPath withOptions:options];
+    } andCompletion:completion];
+    return operation;
+}
+
 
 /**
  * points toward the direction of the curve
@@ -1788,6 +2502,7 @@ static NSInteger segmentCompareCount = 0;
     failedBuildingShape[0] = NO;
     BOOL lastWasRed = [redSegments containsObject:startingSegment];
     while(!failedBuildingShape[0]){
+        throwIfClippingCancelled();
         // we'll set us to failed unless we can add a segment.
         // when we add a segment below, then that triggers that
         // we've not failed
@@ -1844,125 +2559,13 @@ static NSInteger segmentCompareCount = 0;
         return [DKTangentAtPoint tangent:[DKVector vectorWithAngle:[self tangentAtEnd]] atPoint:[self lastPoint]];;
     }
     
-    __block CGFloat entireLength = 0;
-    __block CGPoint lastPoint = CGPointNotFound;
-    [self iteratePathWithBlock:^(CGPathElement element, NSUInteger idx){
-        CGPoint nextLastPoint = lastPoint;
-        if(element.type == kCGPathElementAddLineToPoint){
-            nextLastPoint = element.points[0];
-        }else if(element.type == kCGPathElementAddQuadCurveToPoint){
-            nextLastPoint = element.points[1];
-        }else if(element.type == kCGPathElementAddCurveToPoint){
-            nextLastPoint = element.points[2];
-        }else if(element.type == kCGPathElementMoveToPoint){
-            nextLastPoint = element.points[0];
-        }else if(element.type == kCGPathElementCloseSubpath){
-            nextLastPoint = self.firstPoint;
-        }
-        
-        if(CGPointEqualToPoint(lastPoint, CGPointNotFound) || element.type == kCGPathElementMoveToPoint){
-            lastPoint = element.points[0];
-        }else if(element.type != kCGPathElementCloseSubpath){
-            entireLength += distance(lastPoint, nextLastPoint);
-        }
-        
-        lastPoint = nextLastPoint;
-    }];
-    
-    // at this point, we have a very rough length of the segment.
-    // we treat all curvs as lines, so it's very far from perfect, but
-    // good enough for our needs
-    
-    __block DKTangentAtPoint* ret = nil;
-    
-    
-    const int maxDist = [UIBezierPath maxDistForEndPointTangents];
-    CGFloat lengthAtT = entireLength * tValue;
-    if(tValue > .5){
-        if(lengthAtT < entireLength - maxDist){
-            lengthAtT = entireLength - maxDist;
-            tValue = lengthAtT / entireLength;
-        }
-    }else{
-        if(lengthAtT > maxDist){
-            lengthAtT = maxDist;
-            tValue = lengthAtT / entireLength;
-        }
+    std::vector<DKTangentElement> elements;
+    CGFloat entireLength = measureElementsForTangents(self, &elements);
+    CGPoint tangent, point;
+    if(!tangentNearStartOrEndOfElements(elements, entireLength, tValue, &tangent, &point)){
+        return nil;
     }
-    
-    __block CGFloat tValueToUse = tValue;
-    
-    __block CGFloat lengthSoFar = 0;
-    lastPoint = CGPointNotFound;
-    [self iteratePathWithBlock:^(CGPathElement element, NSUInteger idx){
-        // if we have an answer, just exit
-        if(ret) return;
-        CGPoint nextLastPoint = lastPoint;
-        if(element.type == kCGPathElementAddLineToPoint){
-            nextLastPoint = element.points[0];
-        }else if(element.type == kCGPathElementAddQuadCurveToPoint){
-            nextLastPoint = element.points[1];
-        }else if(element.type == kCGPathElementAddCurveToPoint){
-            nextLastPoint = element.points[2];
-        }else if(element.type == kCGPathElementMoveToPoint){
-            nextLastPoint = element.points[0];
-        }else if(element.type == kCGPathElementCloseSubpath){
-            nextLastPoint = self.firstPoint;
-        }
-        
-        // we're still looking for the element that contains t
-        CGFloat lengthOfElement = 0;
-        if(CGPointEqualToPoint(lastPoint, CGPointNotFound) || element.type == kCGPathElementMoveToPoint){
-            lastPoint = element.points[0];
-            nextLastPoint = lastPoint;
-        }else if(element.type != kCGPathElementCloseSubpath){
-            lengthOfElement = distance(lastPoint, nextLastPoint);
-        }
-        if(lengthSoFar + lengthOfElement > lengthAtT){
-            // this is the element to use for our calculation
-            // scale the tvalue to this element
-            
-            // chop the front of the path off
-            CGFloat tSoFar = lengthSoFar / entireLength;
-            tValueToUse = tValueToUse - tSoFar;
-            
-            // chop off the end of the path
-            CGFloat tDurationOfElement = (lengthOfElement) / entireLength;
-            if(tDurationOfElement){
-                tValueToUse /= tDurationOfElement;
-            }
-            
-            // use this tvalue
-            CGPoint bez[4];
-            bez[0] = lastPoint;
-            bez[3] = element.points[0];
-            if(element.type == kCGPathElementAddLineToPoint){
-                CGFloat width = element.points[0].x - lastPoint.x;
-                CGFloat height = element.points[0].y - lastPoint.y;
-                bez[1] = CGPointMake(lastPoint.x + width/3.0, lastPoint.y + height/3.0);
-                bez[2] = CGPointMake(lastPoint.x + width/3.0*2.0, lastPoint.y + height/3.0*2.0);
-            }else if(element.type == kCGPathElementAddQuadCurveToPoint){
-                bez[0] = lastPoint;
-                bez[1] = element.points[0];
-                bez[2] = element.points[0];
-                bez[3] = element.points[1];
-            }else if(element.type == kCGPathElementAddCurveToPoint){
-                bez[0] = lastPoint;
-                bez[1] = element.points[0];
-                bez[2] = element.points[1];
-                bez[3] = element.points[2];
-            }
-            
-            CGPoint tangent = [UIBezierPath tangentAtT:tValueToUse forBezier:bez];
-            CGPoint point = [UIBezierPath pointAtT:tValueToUse forBezier:bez];
-            
-            ret = [DKTangentAtPoint tangent:[[DKVector vectorWithX:tangent.x andY:tangent.y] normal]  atPoint:point];
-        }
-        lengthSoFar += lengthOfElement;
-        lastPoint = nextLastPoint;
-    }];
-    
-    return ret;
+    return [DKTangentAtPoint tangent:[[DKVector vectorWithX:tangent.x andY:tangent.y] normal] atPoint:point];
 }
 
 
@@ -1986,6 +2589,28 @@ static NSInteger segmentCompareCount = 0;
  * any overlapping bounds (though it would still return quickly)
  */
 +(NSArray*) findIntersectionsBetweenBezier:(CGPoint[4])bez1 andBezier:(CGPoint[4])bez2{
+    return [UIBezierPath findIntersectionsBetweenBezier:bez1 andBezier:bez2 withFatLine:NULL andFatLine:NULL];
+}
+
+/**
+ * same as above, but with the fat lines of either curve already
+ * known. a NULL fat line is computed as needed instead.
+ */
++(NSArray*) findIntersectionsBetweenBezier:(CGPoint[4])bez1 andBezier:(CGPoint[4])bez2 withFatLine:(const Geom::FatLine*)fatLine1 andFatLine:(const Geom::FatLine*)fatLine2{
+    DKIntersectionCache& cache = DKIntersectionCache::shared();
+    std::vector<CGPoint> cachedIntersections;
+    if(cache.lookup(bez1, bez2, kUIBezierClippingPrecision, &cachedIntersections)){
+        segmentCacheHitCount++;
+        NSMutableArray* cachedOutput = [NSMutableArray arrayWithCapacity:cachedIntersections.size()];
+        for(const CGPoint& p : cachedIntersections){
+            [cachedOutput addObject:[NSValue valueWithCGPoint:p]];
+        }
+        return cachedOutput;
+    }
+    if(cache.capacity()){
+        segmentCacheMissCount++;
+    }
+    
     NSMutableArray* intersectionsOutput = [NSMutableArray array];
     NSMutableArray* altIntersectionsOutput = [NSMutableArray array];
     
@@ -2002,8 +2627,8 @@ static NSInteger segmentCompareCount = 0;
     B[2] = Geom::Point(bez2[2].x, bez2[2].y);
     B[3] = Geom::Point(bez2[3].x, bez2[3].y);
     
-    get_solutions(intersectionsOutput, B, A, kUIBezierClippingPrecision, Geom::intersections_clip);
-    get_solutions(altIntersectionsOutput, A, B, kUIBezierClippingPrecision, Geom::intersections_clip);
+    get_solutions(intersectionsOutput, B, A, kUIBezierClippingPrecision, Geom::intersections_clip, fatLine2);
+    get_solutions(altIntersectionsOutput, A, B, kUIBezierClippingPrecision, Geom::intersections_clip, fatLine1);
     
     //
     // This is a bit of a shame, but we'll get different answers out of libgeom
@@ -2025,6 +2650,13 @@ static NSInteger segmentCompareCount = 0;
         }];
         intersectionsOutput = altRet;
     }
+    
+    if(cache.capacity()){
+        for(NSValue* val in intersectionsOutput){
+            cachedIntersections.push_back([val CGPointValue]);
+        }
+        cache.store(bez1, bez2, kUIBezierClippingPrecision, cachedIntersections);
+    }
     return intersectionsOutput;
 }
 
@@ -2095,9 +2727,11 @@ static NSInteger segmentCompareCount = 0;
         bez[3] = element.points[0];
         return element.points[0];
     }else if(element.type == kCGPathElementAddQuadCurveToPoint){
+        // the cubic that traces exactly the same curve as the quad,
+        // with the same t values, so it's clipped where it's drawn
         bez[0] = startPoint;
-        bez[1] = element.points[0];
-        bez[2] = element.points[0];
+        bez[1] = CGPointMake(startPoint.x + (element.points[0].x - startPoint.x)*2.0/3.0, startPoint.y + (element.points[0].y - startPoint.y)*2.0/3.0);
+        bez[2] = CGPointMake(element.points[1].x + (element.points[0].x - element.points[1].x)*2.0/3.0, element.points[1].y + (element.points[0].y - element.points[1].y)*2.0/3.0);
         bez[3] = element.points[1];
         return element.points[1];
     }else if(element.type == kCGPathElementAddCurveToPoint){
@@ -24,9 +24,17 @@
 
 -(NSArray*) uniqueShapeShellsAndSubshapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath;
 
+// the same as above, but also drops closed shapes with
+// less area than minimumArea
+-(NSArray*) uniqueShapeShellsAndSubshapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath withMinimumArea:(CGFloat)minimumArea;
+
+-(NSArray*) uniqueShapesCreatedFromSlicingWithUnclosedPath:(UIBezierPath*)scissorPath withMinimumArea:(CGFloat)minimumArea;
+
 
 +(CGPoint) fillCGPoints:(CGPoint*)bez withElement:(CGPathElement)element givenElementStartingPoint:(CGPoint)startPoint andSubPathStartingPoint:(CGPoint)pathStartPoint;
 
++(CGFloat) estimateArcLengthOf:(CGPoint*)bez1 withSteps:(NSInteger)steps;
+
 #pragma mark - Bezier functions from git@github.com:erich666/GraphicsGems.git
 
 CGPoint NearestPointOnCurve(CGPoint P, CGPoint* V, double* t);
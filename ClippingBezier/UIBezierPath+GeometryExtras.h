@@ -12,6 +12,18 @@
 
 -(CGPoint) closestPointOnPathTo:(CGPoint)point;
 
+// YES if the point is within radius of any part of the path, including
+// the lines that close its subpaths. this is much cheaper than measuring
+// the distance to closestPointOnPathTo:, since elements that are too far
+// away are skipped without being measured, and it stops at the first
+// element that's close enough
+-(BOOL) isPoint:(CGPoint)point withinDistance:(CGFloat)radius;
+
+// the same as isPoint:withinDistance: for each of the count points,
+// writing the answer for points[i] into results[i]. the path is only
+// walked once for all of the points
+-(void) arePoints:(const CGPoint*)points count:(NSUInteger)count withinDistance:(CGFloat)radius results:(BOOL*)results;
+
 -(UIBezierPath*) bezierPathByTrimmingFromClosestPointOnPathFrom:(CGPoint)pointNearTheCurve to:(CGPoint)toPoint;
 
 -(BOOL) containsDuplicateAndReversedSubpaths;
@@ -1,5 +1,5 @@
 //
-//  UIBezierPath+GeometryExtras.m
+//  UIBezierPath+GeometryExtras.mm
 //  ClippingBezier
 //
 //  Created by Adam Wulf on 2/1/15.
@@ -13,6 +13,7 @@
 #import "UIBezierPath+Clipping.h"
 #import "UIBezierPath+Trimming.h"
 #include "NearestPoint.h"
+#include "DKPathElementTable.h"
 
 @implementation UIBezierPath (GeometryExtras)
 
@@ -84,6 +85,69 @@ CGPoint NearestPointOnLine(CGPoint p, CGPoint a, CGPoint b){
     return CGPointMake(a.x + a_to_b.x*t, a.y + a_to_b.y*t );
 }
 
+#pragma mark - Proximity
+
+// unlike CGRectContainsPoint, this includes points on
+// the max edges, and works for rects with no width or height
+static BOOL isPointWithinDistanceOfBounds(CGPoint point, CGFloat radius, CGRect bounds){
+    return point.x >= CGRectGetMinX(bounds) - radius && point.x <= CGRectGetMaxX(bounds) + radius &&
+           point.y >= CGRectGetMinY(bounds) - radius && point.y <= CGRectGetMaxY(bounds) + radius;
+}
+
+static BOOL isPointWithinDistanceOfElement(CGPoint point, CGFloat radius, const DKPathElement& element){
+    if(!isPointWithinDistanceOfBounds(point, radius, element.bounds)){
+        return NO;
+    }
+    if(distance(point, element.bez[0]) <= radius || distance(point, element.bez[3]) <= radius){
+        // this also catches a lone move to, which
+        // is a point that can still be hit
+        return YES;
+    }
+    if(element.type == kCGPathElementMoveToPoint){
+        return NO;
+    }
+    if(element.isLine()){
+        return distance(point, NearestPointOnLine(point, element.bez[0], element.bez[3])) <= radius;
+    }
+    return distance(point, NearestPointOnCurve(point, element.bez, nil)) <= radius;
+}
+
+-(BOOL) isPoint:(CGPoint)point withinDistance:(CGFloat)radius{
+    BOOL result = NO;
+    [self arePoints:&point count:1 withinDistance:radius results:&result];
+    return result;
+}
+
+-(void) arePoints:(const CGPoint*)points count:(NSUInteger)count withinDistance:(CGFloat)radius results:(BOOL*)results{
+    if(!count){
+        return;
+    }
+    memset(results, 0, count * sizeof(BOOL));
+    if(radius < 0){
+        return;
+    }
+    // nothing here is clipped, so only the bounds
+    // and beziers of the elements are needed
+    DKPathElementTable table(self);
+    // the table's bounds leave out move to elements
+    CGRect pathBounds = CGRectNull;
+    for(NSInteger i = 0; i < table.count(); i++){
+        pathBounds = CGRectUnion(pathBounds, table[i].bounds);
+    }
+    for(NSUInteger i = 0; i < count; i++){
+        if(CGRectIsNull(pathBounds) || !isPointWithinDistanceOfBounds(points[i], radius, pathBounds)){
+            // too far from the whole path
+            continue;
+        }
+        for(NSInteger j = 0; j < table.count(); j++){
+            if(isPointWithinDistanceOfElement(points[i], radius, table[j])){
+                results[i] = YES;
+                break;
+            }
+        }
+    }
+}
+
 /**
  * This is an awkward method definition, but the last two arguments
  * are to help optimize bezierPathByTrimmingFromClosestPointOnPathFrom:
@@ -0,0 +1,42 @@
+//
+//  UIBezierPath+Scanlines.h
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+
+/**
+ * a single place where a path crosses a horizontal scanline.
+ * winding is 1 where the path crosses moving toward larger y,
+ * and -1 where it crosses moving toward smaller y.
+ */
+typedef struct {
+    CGFloat x;
+    NSInteger winding;
+} DKScanlineCrossing;
+
+@interface UIBezierPath (Scanlines)
+
+/**
+ * finds everywhere that the path crosses the horizontal lines at
+ * each of the count yValues, and calls the block once for each of
+ * them, in the same order as yValues. the crossings are sorted by x,
+ * and are only valid until the block returns.
+ *
+ * every subpath is treated as closed, the same as when it's filled.
+ * a point is inside the even-odd fill if an odd number of crossings
+ * are to its left, and inside the nonzero fill if the windings of
+ * the crossings to its left don't sum to 0.
+ *
+ * each crossing counts the path at y values from the top of a piece
+ * of the path up to, but not including, its bottom. so a scanline
+ * through a vertex sees it once, and horizontal runs aren't crossed.
+ */
+-(void) enumerateScanlineCrossingsAtYValues:(const CGFloat*)yValues
+                                      count:(NSUInteger)count
+                                 usingBlock:(void (^)(NSUInteger index, const DKScanlineCrossing* crossings, NSUInteger crossingCount))block;
+
+@end
@@ -0,0 +1,317 @@
+//
+//  UIBezierPath+Scanlines.mm
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#import "UIBezierPath+Scanlines.h"
+#import "UIBezierPath+Clipping_Private.h"
+#import "DKPathElementTable.h"
+#import <PerformanceBezier/PerformanceBezier.h>
+#include <vector>
+#include <algorithm>
+
+// roots this close together, in t, are the same root
+#define kUIBezierScanlineRootPrecision 0.000001
+
+/**
+ * a piece of a path that only ever moves up or only ever moves
+ * down, so each scanline that it spans crosses it exactly once
+ */
+struct ScanlinePiece {
+    CGPoint bez[4];
+    // the range of the bezier that this piece covers
+    CGFloat t0;
+    CGFloat t1;
+    CGFloat minY;
+    CGFloat maxY;
+    NSInteger winding;
+    bool isLine;
+};
+
+/**
+ * the t values in (0, 1) where the y of the bezier turns around,
+ * from the roots of its derivative
+ */
+static NSInteger turningPointsOfBezier(const CGPoint* bez, CGFloat* turns){
+    CGFloat a = 3 * (-bez[0].y + 3 * bez[1].y - 3 * bez[2].y + bez[3].y);
+    CGFloat b = 6 * (bez[0].y - 2 * bez[1].y + bez[2].y);
+    CGFloat c = 3 * (bez[1].y - bez[0].y);
+    CGFloat candidates[2];
+    NSInteger candidateCount = 0;
+    if(ABS(a) < 1e-12){
+        if(ABS(b) > 1e-12){
+            candidates[candidateCount++] = -c / b;
+        }
+    }else{
+        CGFloat discriminant = b * b - 4 * a * c;
+        if(discriminant > 0){
+            CGFloat root = sqrt(discriminant);
+            candidates[candidateCount++] = (-b - root) / (2 * a);
+            candidates[candidateCount++] = (-b + root) / (2 * a);
+        }
+    }
+    NSInteger turnCount = 0;
+    for(NSInteger i = 0; i < candidateCount; i++){
+        if(candidates[i] > 0 && candidates[i] < 1){
+            turns[turnCount++] = candidates[i];
+        }
+    }
+    std::sort(turns, turns + turnCount);
+    return turnCount;
+}
+
+static void addScanlinePiece(std::vector<ScanlinePiece>* pieces, const CGPoint* bez, CGFloat t0, CGFloat t1, bool isLine){
+    CGFloat y0 = isLine ? bez[0].y + (bez[3].y - bez[0].y) * t0 : [UIBezierPath pointAtT:t0 forBezier:(CGPoint*)bez].y;
+    CGFloat y1 = isLine ? bez[0].y + (bez[3].y - bez[0].y) * t1 : [UIBezierPath pointAtT:t1 forBezier:(CGPoint*)bez].y;
+    if(y0 == y1){
+        // horizontal pieces never cross a scanline
+        return;
+    }
+    ScanlinePiece piece;
+    memcpy(piece.bez, bez, sizeof(piece.bez));
+    piece.t0 = t0;
+    piece.t1 = t1;
+    piece.minY = MIN(y0, y1);
+    piece.maxY = MAX(y0, y1);
+    piece.winding = y1 > y0 ? 1 : -1;
+    piece.isLine = isLine;
+    pieces->push_back(piece);
+}
+
+static void addScanlineLine(std::vector<ScanlinePiece>* pieces, CGPoint start, CGPoint end){
+    CGPoint bez[4] = { start, start, end, end };
+    addScanlinePiece(pieces, bez, 0, 1, true);
+}
+
+static void addScanlineCurve(std::vector<ScanlinePiece>* pieces, const CGPoint* bez){
+    CGFloat turns[2];
+    NSInteger turnCount = turningPointsOfBezier(bez, turns);
+    CGFloat t0 = 0;
+    for(NSInteger i = 0; i <= turnCount; i++){
+        CGFloat t1 = (i < turnCount) ? turns[i] : 1;
+        addScanlinePiece(pieces, bez, t0, t1, false);
+        t0 = t1;
+    }
+}
+
+/**
+ * the x where the piece crosses the scanline at y, which
+ * has to be within the piece's range of y values
+ */
+static CGFloat xOfScanlinePieceAtY(const ScanlinePiece& piece, CGFloat y){
+    if(piece.isLine){
+        CGFloat t = (y - piece.bez[0].y) / (piece.bez[3].y - piece.bez[0].y);
+        return piece.bez[0].x + (piece.bez[3].x - piece.bez[0].x) * t;
+    }
+    CGFloat roots[3];
+    NSInteger rootCount = DKRootsOfBezierAxisAtValue(piece.bez[0].y, piece.bez[1].y, piece.bez[2].y, piece.bez[3].y, y, kUIBezierScanlineRootPrecision, roots);
+    for(NSInteger i = 0; i < rootCount; i++){
+        if(roots[i] >= piece.t0 - kUIBezierScanlineRootPrecision && roots[i] <= piece.t1 + kUIBezierScanlineRootPrecision){
+            return [UIBezierPath pointAtT:roots[i] forBezier:(CGPoint*)piece.bez].x;
+        }
+    }
+    // the solver can lose a root right at a turning point,
+    // so fall back to bisecting the monotone piece
+    CGFloat low = piece.t0;
+    CGFloat high = piece.t1;
+    for(int i = 0; i < 52 && high - low > kUIBezierScanlineRootPrecision * kUIBezierScanlineRootPrecision; i++){
+        CGFloat mid = (low + high) / 2;
+        CGFloat midY = [UIBezierPath pointAtT:mid forBezier:(CGPoint*)piece.bez].y;
+        if((midY < y) == (piece.winding > 0)){
+            low = mid;
+        }else{
+            high = mid;
+        }
+    }
+    return [UIBezierPath pointAtT:(low + high) / 2 forBezier:(CGPoint*)piece.bez].x;
+}
+
+#if defined(__clang__) || defined(__GNUC__)
+/*
+ * a curve piece usually spans a run of many scanlines, so where the
+ * compiler has vector extensions its crossings are found a register's
+ * worth of scanlines at a time, the same way bezier-utils.cpp fits
+ * points. two doubles for NEON and SSE2, four for AVX
+ */
+#ifdef __AVX__
+#define kUIBezierScanlineLanes 4
+#else
+#define kUIBezierScanlineLanes 2
+#endif
+typedef double scanline_d __attribute__((vector_size(kUIBezierScanlineLanes * sizeof(double))));
+typedef decltype(scanline_d() < scanline_d()) scanline_m;
+
+static inline scanline_d scanlineSplat(double x){
+    scanline_d ret;
+    for(int k = 0; k < kUIBezierScanlineLanes; k++){
+        ret[k] = x;
+    }
+    return ret;
+}
+
+static inline scanline_d scanlineSelect(scanline_m mask, scanline_d a, scanline_d b){
+    return (scanline_d)(((scanline_m)a & mask) | ((scanline_m)b & ~mask));
+}
+
+static inline bool scanlineAny(scanline_m mask){
+    for(int k = 0; k < kUIBezierScanlineLanes; k++){
+        if(mask[k]){
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * the x where the curve piece crosses each of the count scanlines,
+ * which all have to be within the piece's range of y values. each
+ * lane runs newton's method on its own scanline, and bisects
+ * instead whenever a step would leave the bracket around its root,
+ * so it always converges on the one root inside the monotone piece
+ */
+static void xsOfScanlineCurvePieceAtYs(const ScanlinePiece& piece, const CGFloat* yValues, NSUInteger count, CGFloat* xValues){
+    const CGPoint* bez = piece.bez;
+    // the power basis of the curve, so each lane only
+    // needs a few multiplies for its point and slope
+    scanline_d const ay = scanlineSplat(-bez[0].y + 3 * bez[1].y - 3 * bez[2].y + bez[3].y);
+    scanline_d const by = scanlineSplat(3 * (bez[0].y - 2 * bez[1].y + bez[2].y));
+    scanline_d const cy = scanlineSplat(3 * (bez[1].y - bez[0].y));
+    scanline_d const dy = scanlineSplat(bez[0].y);
+    scanline_d const ax = scanlineSplat(-bez[0].x + 3 * bez[1].x - 3 * bez[2].x + bez[3].x);
+    scanline_d const bx = scanlineSplat(3 * (bez[0].x - 2 * bez[1].x + bez[2].x));
+    scanline_d const cx = scanlineSplat(3 * (bez[1].x - bez[0].x));
+    scanline_d const dx = scanlineSplat(bez[0].x);
+    // flips decreasing pieces, so y always grows with t
+    scanline_d const sign = scanlineSplat(piece.winding);
+    scanline_d const zero = scanlineSplat(0);
+    scanline_d const precision = scanlineSplat(kUIBezierScanlineRootPrecision);
+    CGFloat const rangeY = piece.maxY - piece.minY;
+
+    for(NSUInteger i = 0; i < count; i += kUIBezierScanlineLanes){
+        // the last group repeats its last scanline to fill the lanes
+        scanline_d y, t;
+        for(int k = 0; k < kUIBezierScanlineLanes; k++){
+            CGFloat laneY = yValues[MIN(i + k, count - 1)];
+            CGFloat fraction = (piece.winding > 0 ? laneY - piece.minY : piece.maxY - laneY) / rangeY;
+            y[k] = laneY;
+            t[k] = piece.t0 + (piece.t1 - piece.t0) * fraction;
+        }
+        scanline_d low = scanlineSplat(piece.t0);
+        scanline_d high = scanlineSplat(piece.t1);
+        scanline_m active = zero == zero;
+        for(int iteration = 0; iteration < 64 && scanlineAny(active); iteration++){
+            scanline_d const error = sign * (((ay * t + by) * t + cy) * t + dy - y);
+            scanline_d const slope = sign * ((3 * ay * t + 2 * by) * t + cy);
+            scanline_m const below = error < zero;
+            low = scanlineSelect(below, t, low);
+            high = scanlineSelect(below, high, t);
+            // a flat slope gives an infinite or NaN step, which
+            // fails both comparisons and bisects instead
+            scanline_d next = t - error / slope;
+            next = scanlineSelect((next > low) & (next < high), next, (low + high) * 0.5);
+            scanline_d const step = scanlineSelect(next > t, next - t, t - next);
+            t = scanlineSelect(active, next, t);
+            active &= (step > precision) & (high - low > precision) & (error != zero);
+        }
+        scanline_d const x = ((ax * t + bx) * t + cx) * t + dx;
+        for(int k = 0; k < kUIBezierScanlineLanes && i + k < count; k++){
+            xValues[i + k] = x[k];
+        }
+    }
+}
+#endif
+
+
+@implementation UIBezierPath (Scanlines)
+
+-(void) enumerateScanlineCrossingsAtYValues:(const CGFloat*)yValues
+                                      count:(NSUInteger)count
+                                 usingBlock:(void (^)(NSUInteger index, const DKScanlineCrossing* crossings, NSUInteger crossingCount))block{
+    if(!count){
+        return;
+    }
+
+    // split the path into pieces that each only move up or down
+    std::vector<ScanlinePiece> piecesStorage;
+    // blocks can't capture the vector by reference, so
+    // hand it in through a pointer
+    std::vector<ScanlinePiece>* pieces = &piecesStorage;
+    __block CGPoint lastPoint = CGPointZero;
+    __block CGPoint subpathStartingPoint = CGPointZero;
+    __block BOOL hasSubpath = NO;
+    [self iteratePathWithBlock:^(CGPathElement element, NSUInteger idx){
+        if(element.type == kCGPathElementMoveToPoint && hasSubpath){
+            // filling closes every subpath
+            addScanlineLine(pieces, lastPoint, subpathStartingPoint);
+        }
+        CGPoint bez[4];
+        CGPoint endPoint = [UIBezierPath fillCGPoints:bez withElement:element givenElementStartingPoint:lastPoint andSubPathStartingPoint:subpathStartingPoint];
+        if(element.type == kCGPathElementMoveToPoint){
+            subpathStartingPoint = endPoint;
+            hasSubpath = YES;
+        }else if(element.type == kCGPathElementAddLineToPoint || element.type == kCGPathElementCloseSubpath){
+            addScanlineLine(pieces, bez[0], bez[3]);
+        }else{
+            addScanlineCurve(pieces, bez);
+        }
+        lastPoint = endPoint;
+    }];
+    if(hasSubpath){
+        addScanlineLine(pieces, lastPoint, subpathStartingPoint);
+    }
+
+    // sort the scanlines, so that each piece can find the run of
+    // scanlines that it spans with a binary search, and then
+    // only visits those scanlines
+    std::vector<NSUInteger> order(count);
+    for(NSUInteger i = 0; i < count; i++){
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [yValues](NSUInteger a, NSUInteger b){
+        return yValues[a] < yValues[b];
+    });
+    std::vector<CGFloat> sortedY(count);
+    for(NSUInteger i = 0; i < count; i++){
+        sortedY[i] = yValues[order[i]];
+    }
+
+    std::vector<std::vector<DKScanlineCrossing>> crossings(count);
+    std::vector<CGFloat> xValues;
+    for(const ScanlinePiece& piece : piecesStorage){
+        NSUInteger first = std::lower_bound(sortedY.begin(), sortedY.end(), piece.minY) - sortedY.begin();
+        NSUInteger last = first;
+        while(last < count && sortedY[last] < piece.maxY){
+            last++;
+        }
+        xValues.resize(last - first);
+#if defined(__clang__) || defined(__GNUC__)
+        if(!piece.isLine && last > first){
+            xsOfScanlineCurvePieceAtYs(piece, &sortedY[first], last - first, &xValues[0]);
+        }else
+#endif
+        {
+            for(NSUInteger i = first; i < last; i++){
+                xValues[i - first] = xOfScanlinePieceAtY(piece, sortedY[i]);
+            }
+        }
+        for(NSUInteger i = first; i < last; i++){
+            DKScanlineCrossing crossing;
+            crossing.x = xValues[i - first];
+            crossing.winding = piece.winding;
+            crossings[order[i]].push_back(crossing);
+        }
+    }
+
+    for(NSUInteger i = 0; i < count; i++){
+        std::vector<DKScanlineCrossing>& scanline = crossings[i];
+        std::sort(scanline.begin(), scanline.end(), [](const DKScanlineCrossing& a, const DKScanlineCrossing& b){
+            return a.x < b.x;
+        });
+        block(i, scanline.data(), scanline.size());
+    }
+}
+
+@end
@@ -0,0 +1,32 @@
+//
+//  UIBezierPath+Simplification.h
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+
+@interface UIBezierPath (Simplification)
+
+/**
+ * returns a path that stays within tolerance of self, but
+ * with runs of its elements refit as fewer cubic curves.
+ *
+ * elements that meet at more than cornerAngle radians are
+ * never merged into the same curve, and moveTo and closePath
+ * elements are always kept as is.
+ *
+ * if elementMapping is non-nil, it is filled with one NSValue
+ * of an NSRange per element of the returned path, giving the
+ * range of element indexes in self that the element replaced.
+ * a refit curve can end partway along one of self's curves, and
+ * then that curve is in the ranges of both the refit curve and
+ * the one after it, so adjacent ranges can overlap by an element.
+ */
+-(UIBezierPath*) bezierPathBySimplifyingWithTolerance:(CGFloat)tolerance
+                                       andCornerAngle:(CGFloat)cornerAngle
+                                       elementMapping:(NSArray**)elementMapping;
+
+@end
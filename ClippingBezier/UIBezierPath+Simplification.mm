@@ -0,0 +1,216 @@
+//
+//  UIBezierPath+Simplification.mm
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//  Copyright (c) 2016 Adam Wulf. All rights reserved.
+//
+
+#import "UIBezierPath+Simplification.h"
+#import "UIBezierPath+Clipping_Private.h"
+#import <PerformanceBezier/PerformanceBezier.h>
+#include "bezier-utils.h"
+#include <vector>
+
+// the most points we'll sample from a single curve element
+#define kUIBezierSimplificationMaxSamples 16
+
+/**
+ * a copy of a single path element, since the points
+ * of a CGPathElement are only valid during iteration
+ */
+struct SimplifiedElement {
+    CGPathElementType type;
+    CGPoint points[3];
+};
+
+/**
+ * holds a run of consecutive drawing elements that have
+ * no corners between them, along with the points we've
+ * sampled from them to refit.
+ */
+struct SimplificationRun {
+    NSInteger firstElementIndex;
+    std::vector<SimplifiedElement> elements;
+    std::vector<Geom::Point> points;
+    // the index into elements for the element that
+    // each of the points was sampled from
+    std::vector<NSInteger> pointElement;
+    CGPoint endTangent;
+};
+
+static CGPoint startTangentOfBezier(CGPoint* bez){
+    for(int i=1;i<4;i++){
+        if(!CGPointEqualToPoint(bez[i], bez[0])){
+            return CGPointMake(bez[i].x - bez[0].x, bez[i].y - bez[0].y);
+        }
+    }
+    return CGPointZero;
+}
+
+static CGPoint endTangentOfBezier(CGPoint* bez){
+    for(int i=2;i>=0;i--){
+        if(!CGPointEqualToPoint(bez[i], bez[3])){
+            return CGPointMake(bez[3].x - bez[i].x, bez[3].y - bez[i].y);
+        }
+    }
+    return CGPointZero;
+}
+
+static CGFloat angleBetweenTangents(CGPoint a, CGPoint b){
+    CGFloat lengths = sqrt(a.x * a.x + a.y * a.y) * sqrt(b.x * b.x + b.y * b.y);
+    if(lengths == 0){
+        return 0;
+    }
+    CGFloat cosAngle = (a.x * b.x + a.y * b.y) / lengths;
+    return acos(MAX(-1.0, MIN(1.0, cosAngle)));
+}
+
+static void appendElement(UIBezierPath* path, const SimplifiedElement& element){
+    if(element.type == kCGPathElementAddLineToPoint){
+        [path addLineToPoint:element.points[0]];
+    }else if(element.type == kCGPathElementAddQuadCurveToPoint){
+        [path addQuadCurveToPoint:element.points[1] controlPoint:element.points[0]];
+    }else if(element.type == kCGPathElementAddCurveToPoint){
+        [path addCurveToPoint:element.points[2] controlPoint1:element.points[0] controlPoint2:element.points[1]];
+    }
+}
+
+
+@implementation UIBezierPath (Simplification)
+
+/**
+ * adds the run to the output path, either as the curves that
+ * we've refit it to, or as its original elements if the fit
+ * wouldn't save any elements.
+ */
++(void) appendSimplificationRun:(SimplificationRun*)run toPath:(UIBezierPath*)path withMapping:(NSMutableArray*)mapping andTolerance:(CGFloat)tolerance{
+    NSInteger elementCount = run->elements.size();
+    if(!elementCount){
+        return;
+    }
+    int nsegs = -1;
+    std::vector<Geom::Point> fit(elementCount * 4);
+    int const len = (int)run->points.size();
+    if(elementCount > 1 && len > 2){
+        Geom::Point const unconstrained(0, 0);
+        nsegs = Geom::bezier_fit_cubic_full(&fit[0], NULL, &run->points[0], len,
+                                            unconstrained, unconstrained,
+                                            tolerance * tolerance, (unsigned)elementCount);
+    }
+    if(nsegs <= 0 || nsegs >= elementCount){
+        // the fit can't do any better than what we already have
+        for(NSInteger i=0;i<elementCount;i++){
+            appendElement(path, run->elements[i]);
+            [mapping addObject:[NSValue valueWithRange:NSMakeRange(run->firstElementIndex + i, 1)]];
+        }
+    }else{
+        // each fit curve ends exactly on one of the points we sampled,
+        // so find that point to know which elements the curve replaced
+        int startPoint = 0;
+        for(int seg=0;seg<nsegs;seg++){
+            Geom::Point const* bez = &fit[seg * 4];
+            int endPoint = startPoint + 1;
+            if(seg == nsegs - 1){
+                endPoint = len - 1;
+            }else{
+                while(endPoint < len - 1 && run->points[endPoint] != bez[3]){
+                    endPoint++;
+                }
+            }
+            NSInteger firstElement = seg ? run->pointElement[startPoint + 1] : 0;
+            NSInteger lastElement = (seg == nsegs - 1) ? elementCount - 1 : run->pointElement[endPoint];
+            [path addCurveToPoint:CGPointMake(bez[3][Geom::X], bez[3][Geom::Y])
+                    controlPoint1:CGPointMake(bez[1][Geom::X], bez[1][Geom::Y])
+                    controlPoint2:CGPointMake(bez[2][Geom::X], bez[2][Geom::Y])];
+            [mapping addObject:[NSValue valueWithRange:NSMakeRange(run->firstElementIndex + firstElement, lastElement - firstElement + 1)]];
+            startPoint = endPoint;
+        }
+    }
+    run->elements.clear();
+    run->points.clear();
+    run->pointElement.clear();
+}
+
+-(UIBezierPath*) bezierPathBySimplifyingWithTolerance:(CGFloat)tolerance
+                                       andCornerAngle:(CGFloat)cornerAngle
+                                       elementMapping:(NSArray**)elementMapping{
+    UIBezierPath* simplePath = [UIBezierPath bezierPath];
+    NSMutableArray* mapping = [NSMutableArray array];
+
+    SimplificationRun runStorage;
+    // blocks can't capture the run by reference, so
+    // hand it in through a pointer
+    SimplificationRun* run = &runStorage;
+
+    __block CGPoint lastPoint = CGPointZero;
+    __block CGPoint subpathStartingPoint = CGPointZero;
+    [self iteratePathWithBlock:^(CGPathElement element, NSUInteger idx){
+        if(element.type == kCGPathElementMoveToPoint || element.type == kCGPathElementCloseSubpath){
+            [UIBezierPath appendSimplificationRun:run toPath:simplePath withMapping:mapping andTolerance:tolerance];
+            if(element.type == kCGPathElementMoveToPoint){
+                [simplePath moveToPoint:element.points[0]];
+                lastPoint = element.points[0];
+                subpathStartingPoint = element.points[0];
+            }else{
+                [simplePath closePath];
+                lastPoint = subpathStartingPoint;
+            }
+            [mapping addObject:[NSValue valueWithRange:NSMakeRange(idx, 1)]];
+            return;
+        }
+
+        CGPoint bez[4];
+        CGPoint startPoint = lastPoint;
+        lastPoint = [UIBezierPath fillCGPoints:bez withElement:element givenElementStartingPoint:startPoint andSubPathStartingPoint:subpathStartingPoint];
+
+        CGPoint startTangent = startTangentOfBezier(bez);
+        if(run->elements.size() && angleBetweenTangents(run->endTangent, startTangent) > cornerAngle){
+            // corners always split a run
+            [UIBezierPath appendSimplificationRun:run toPath:simplePath withMapping:mapping andTolerance:tolerance];
+        }
+        if(!run->elements.size()){
+            run->firstElementIndex = idx;
+            run->points.push_back(Geom::Point(startPoint.x, startPoint.y));
+            run->pointElement.push_back(0);
+            run->endTangent = CGPointZero;
+        }
+
+        SimplifiedElement copy;
+        copy.type = element.type;
+        int pointCount = element.type == kCGPathElementAddCurveToPoint ? 3 : element.type == kCGPathElementAddQuadCurveToPoint ? 2 : 1;
+        for(int i=0;i<pointCount;i++){
+            copy.points[i] = element.points[i];
+        }
+        run->elements.push_back(copy);
+        NSInteger runElementIndex = run->elements.size() - 1;
+
+        // lines only need their end point, but curves need enough
+        // samples along them for the fit to follow their shape
+        int samples = 1;
+        if(element.type != kCGPathElementAddLineToPoint){
+            CGFloat polygonLength = distance(bez[0], bez[1]) + distance(bez[1], bez[2]) + distance(bez[2], bez[3]);
+            samples = (int) MAX(2, MIN(kUIBezierSimplificationMaxSamples, ceil(polygonLength / MAX(tolerance * 4, 1))));
+        }
+        for(int i=1;i<=samples;i++){
+            CGPoint p = (i == samples) ? bez[3] : [UIBezierPath pointAtT:(CGFloat)i / samples forBezier:bez];
+            Geom::Point sample(p.x, p.y);
+            if(sample != run->points.back()){
+                run->points.push_back(sample);
+                run->pointElement.push_back(runElementIndex);
+            }
+        }
+        CGPoint endTangent = endTangentOfBezier(bez);
+        if(!CGPointEqualToPoint(endTangent, CGPointZero)){
+            run->endTangent = endTangent;
+        }
+    }];
+    [UIBezierPath appendSimplificationRun:run toPath:simplePath withMapping:mapping andTolerance:tolerance];
+
+    if(elementMapping){
+        *elementMapping = mapping;
+    }
+    return simplePath;
+}
+
+@end
@@ -9,6 +9,10 @@
 #ifndef ClippingBezier_bezier_clipping_h
 #define ClippingBezier_bezier_clipping_h
 
+#include <vector>
+#include "interval.h"
+#include "point.h"
+
 namespace Geom {
 
     typedef void clip_fnc_t (Interval &,
@@ -21,11 +25,58 @@ namespace Geom {
                              std::vector<Point> const& B,
                              double precision);
     
+    /*
+     * The fat line of a curve: its normalized orientation line
+     * line[0] * x + line[1] * y + line[2] == 0, and the range of
+     * distances of its control points from that line. perp_line and
+     * perp_bound are the same for the line perpendicular to it through
+     * the first control point.
+     */
+    struct FatLine
+    {
+        double line[3];
+        Interval bound;
+        double perp_line[3];
+        Interval perp_bound;
+    };
+    
+    /*
+     * Compute the fat line that intersections_clip would use for the
+     * curve "A" at the input precision. Returns false, and leaves "fl"
+     * untouched, if "A" is constant and has no fat line.
+     */
+    bool fat_line (FatLine & fl,
+                   std::vector<Point> const& A,
+                   double precision);
+    
+    /*
+     * Clip the curve "B" against a fat line computed ahead of time
+     */
+    void clip_with_fat_line (Interval & dom,
+                             FatLine const& fl,
+                             std::vector<Point> const& B);
+    
+    /*
+     * The number of times that a clip step removed too little of a
+     * curve, and it had to be split in half instead, on
+     * the calling thread
+     */
+    size_t get_split_count ();
+    
+    void reset_split_count ();
+    
+    /*
+     * if fatA is not NULL, it must be the fat_line() of A at the same
+     * precision, and saves the first clip step from computing it again
+     */
     void get_solutions (NSMutableArray* xs,
                         std::vector<Point> const& A,
                         std::vector<Point> const& B,
                         double precision,
-                        clip_fnc_t* clip);
+                        clip_fnc_t* clip,
+                        FatLine const* fatA = NULL);
+    
+    void convex_hull (std::vector<Point> & P);
     
 }
 #endif
@@ -44,6 +44,7 @@
 
 #include "interval.h"
 #include <vector>
+#include <algorithm>
 #include "bezierclip.hxx"
 #include "point.h"
 #import <CoreGraphics/CoreGraphics.h>
@@ -90,6 +91,21 @@ namespace Geom {
     const Interval H1_INTERVAL(0, 0.5);
     const Interval H2_INTERVAL(0.5 + MAX_PRECISION, 1.0);
     
+    // counts the halving splits in iterate(). each thread
+    // has its own count, so clipping in the background
+    // doesn't change the count on the calling thread
+    static thread_local size_t split_count = 0;
+    
+    size_t get_split_count ()
+    {
+        return split_count;
+    }
+    
+    void reset_split_count ()
+    {
+        split_count = 0;
+    }
+    
     
     
 #pragma mark - bezier curve routines
@@ -249,10 +265,12 @@ namespace Geom {
                   Interval const& domA,
                   Interval const& domB,
                   double precision,
-                  clip_fnc_t* clip)
+                  clip_fnc_t* clip,
+                  FatLine const* fatA = NULL)
     {
-        // in order to limit recursion
-        static size_t counter = 0;
+        // in order to limit recursion. each thread clips its
+        // own curves, so each needs its own count
+        static thread_local size_t counter = 0;
         if (domA.extent() == 1 && domB.extent() == 1) counter  = 0;
         if (++counter > 100){
             return;
@@ -296,7 +314,16 @@ namespace Geom {
 #if VERBOSE
             std::cerr << "iter: " << iter << std::endl;
 #endif
-            clip(dom, *C1, *C2, precision);
+            if (iter == 1 && fatA != NULL && clip == &intersections_clip)
+            {
+                // the first step always clips B against all of A, and the
+                // caller has already worked out the fat line of A for us
+                clip_with_fat_line(dom, *fatA, *C2);
+            }
+            else
+            {
+                clip(dom, *C1, *C2, precision);
+            }
             
             // [1,0] is utilized to represent an empty interval
             if (dom == EMPTY_INTERVAL)
@@ -345,6 +372,7 @@ namespace Geom {
                 std::cerr << "angle(pA) : " << angle(pA) << std::endl;
                 std::cerr << "angle(pB) : " << angle(pB) << std::endl;
 #endif
+                split_count++;
                 std::vector<Point> pC1, pC2;
                 Interval dompC1, dompC2;
                 if (dompA.extent() > dompB.extent())
@@ -541,7 +569,8 @@ namespace Geom {
                         std::vector<Point> const& A,
                         std::vector<Point> const& B,
                         double precision,
-                        clip_fnc_t* clip)
+                        clip_fnc_t* clip,
+                        FatLine const* fatA)
     {
         
         if(is_constant(A,precision) || is_constant(B,precision)){
@@ -551,7 +580,7 @@ namespace Geom {
         
         CGPoint ci;
         std::vector<Interval> domsA, domsB;
-        iterate (domsA, domsB, A, B, UNIT_INTERVAL, UNIT_INTERVAL, precision, clip);
+        iterate (domsA, domsB, A, B, UNIT_INTERVAL, UNIT_INTERVAL, precision, clip, fatA);
         if (domsA.size() != domsB.size())
         {
             assert (domsA.size() == domsB.size());
@@ -656,16 +685,66 @@ namespace Geom {
         P.resize(l);
     }
     
+    /*
+     * The same scan as convex_hull, for the 3 or 4 points of a quadratic or
+     * cubic distance curve. The points must already be in lexicographic order,
+     * which the distance curve always is since its x values are i/n.
+     * Everything stays on the stack, and the only sorting left is of the at
+     * most two points that aren't on the upper hull, which is a single
+     * compare and swap. Returns the number of points on the hull, which are
+     * in the same order that convex_hull would put them.
+     */
+    inline
+    size_t convex_hull_sorted_small (Point P[], size_t n)
+    {
+        assert(n <= 4);
+        if (n < 4) return n;
+        // upper hull
+        size_t u = 2;
+        for (size_t i = 2; i < n; ++i)
+        {
+            while (u > 1 && !is_a_right_turn(P[u-2], P[u-1], P[i]))
+            {
+                --u;
+            }
+            std::swap(P[u], P[i]);
+            ++u;
+        }
+        if (n - u == 2 && lex_greater()(P[u+1], P[u]))
+        {
+            std::swap(P[u], P[u+1]);
+        }
+        Point first = P[0];
+        for (size_t i = 1; i < n; ++i)
+        {
+            P[i-1] = P[i];
+        }
+        P[n-1] = first;
+        // lower hull
+        size_t l = u;
+        size_t k = u - 1;
+        for (size_t i = l; i < n; ++i)
+        {
+            while (l > k && !is_a_right_turn(P[l-2], P[l-1], P[i]))
+            {
+                --l;
+            }
+            std::swap(P[l], P[i]);
+            ++l;
+        }
+        return l;
+    }
+    
     
 #pragma mark - intersection
     
     /*
      *  Make up an orientation line using the control points c[i] and c[j]
      *  the line is returned in the output parameter "l" in the form of a 3 element
-     *  vector : l[0] * x + l[1] * y + l[2] == 0; the line is normalized.
+     *  array : l[0] * x + l[1] * y + l[2] == 0; the line is normalized.
      */
     inline
-    void orientation_line (std::vector<double> & l,
+    void orientation_line (double l[],
                            std::vector<Point> const& c,
                            size_t i, size_t j)
     {
@@ -684,7 +763,7 @@ namespace Geom {
      * the output parameter "l"
      */
     inline
-    void pick_orientation_line (std::vector<double> & l,
+    void pick_orientation_line (double l[],
                                 std::vector<Point> const& c,
                                 double precision)
     {
@@ -703,11 +782,26 @@ namespace Geom {
         //std::cerr << "i = " << i << std::endl;
     }
     
+    /*
+     * Make up the line perpendicular to the normalized orientation line "l"
+     * that passes through the first control point of "c", and return it in
+     * the output parameter "p"
+     */
+    inline
+    void perpendicular_line (double p[],
+                             double const l[],
+                             std::vector<Point> const& c)
+    {
+        p[0] = -l[1];
+        p[1] = l[0];
+        p[2] = -(p[0] * c[0][X] + p[1] * c[0][Y]);
+    }
+    
     /*
      *  Compute the signed distance of the point "P" from the normalized line l
      */
     inline
-    double distancePtoL (Point const& P, std::vector<double> const& l)
+    double distancePtoL (Point const& P, double const l[])
     {
         return l[X] * P[X] + l[Y] * P[Y] + l[2];
     }
@@ -720,7 +814,7 @@ namespace Geom {
     inline
     void fat_line_bounds (Interval& bound,
                           std::vector<Point> const& c,
-                          std::vector<double> const& l)
+                          double const l[])
     {
         bound[0] = 0;
         bound[1] = 0;
@@ -750,30 +844,15 @@ namespace Geom {
     
     
     /*
-     * Clip the Bezier curve "B" wrt the fat line defined by the orientation
-     * line "l" and the interval range "bound", the new parameter interval for
-     * the clipped curve is returned through the output parameter "dom"
+     * Clip the convex hull "p" of a distance curve wrt the interval range
+     * "bound", the new parameter interval is returned through the output
+     * parameter "dom"
      */
-    void clip_interval (Interval& dom,
-                        std::vector<Point> const& B,
-                        std::vector<double> const& l,
-                        Interval const& bound)
+    void clip_hull_interval (Interval& dom,
+                             Point const p[],
+                             size_t hull_size,
+                             Interval const& bound)
     {
-        double n = B.size() - 1;  // number of sub-intervals
-        std::vector<Point> D;     // distance curve control points
-        D.reserve (B.size());
-        double d;
-        for (size_t i = 0; i < B.size(); ++i)
-        {
-            d = distancePtoL (B[i], l);
-            D.push_back (Point(i/n, d));
-        }
-        //print(D);
-        
-        convex_hull(D);
-        std::vector<Point> & p = D;
-        //print(p);
-        
         bool plower, phigher;
         bool clower, chigher;
         double t, tmin = 1, tmax = 0;
@@ -789,7 +868,7 @@ namespace Geom {
             //          << " : tmin = " << tmin << ", tmax = " << tmax << std::endl;
         }
         
-        for (size_t i = 1; i < p.size(); ++i)
+        for (size_t i = 1; i < hull_size; ++i)
         {
             clower = (p[i][Y] < bound.min());
             chigher = (p[i][Y] > bound.max());
@@ -824,7 +903,7 @@ namespace Geom {
         }
         
         // we have to test the closing segment for intersection
-        size_t last = p.size() - 1;
+        size_t last = hull_size - 1;
         clower = (p[0][Y] < bound.min());
         chigher = (p[0][Y] > bound.max());
         if (clower != plower)  // cross the lower bound
@@ -848,6 +927,93 @@ namespace Geom {
         dom[1] = tmax;
     }
     
+    /*
+     * Clip the Bezier curve "B" wrt the fat line defined by the orientation
+     * line "l" and the interval range "bound", the new parameter interval for
+     * the clipped curve is returned through the output parameter "dom"
+     */
+    void clip_interval (Interval& dom,
+                        std::vector<Point> const& B,
+                        double const l[],
+                        Interval const& bound)
+    {
+        double n = B.size() - 1;  // number of sub-intervals
+        if (B.size() == 3 || B.size() == 4)
+        {
+            // quadratics and cubics are the only curves we ever clip, so
+            // keep their distance curve on the stack
+            Point D[4];
+            for (size_t i = 0; i < B.size(); ++i)
+            {
+                D[i] = Point(i/n, distancePtoL (B[i], l));
+            }
+            size_t hull_size = convex_hull_sorted_small(D, B.size());
+            clip_hull_interval(dom, D, hull_size, bound);
+            return;
+        }
+        
+        std::vector<Point> D;     // distance curve control points
+        D.reserve (B.size());
+        double d;
+        for (size_t i = 0; i < B.size(); ++i)
+        {
+            d = distancePtoL (B[i], l);
+            D.push_back (Point(i/n, d));
+        }
+        //print(D);
+        
+        convex_hull(D);
+        //print(D);
+        clip_hull_interval(dom, &D[0], D.size(), bound);
+    }
+    
+    
+    
+    /*
+     * Fill in both the fat line of the curve "A" and the fat line
+     * perpendicular to it
+     */
+    inline
+    void fill_fat_line (FatLine & fl,
+                        std::vector<Point> const& A,
+                        double precision)
+    {
+        pick_orientation_line(fl.line, A, precision);
+        fat_line_bounds(fl.bound, A, fl.line);
+        perpendicular_line(fl.perp_line, fl.line, A);
+        fat_line_bounds(fl.perp_bound, A, fl.perp_line);
+    }
+    
+    /*
+     * Clip the Bezier curve "B" against the fat lines in "fl". Each clip
+     * alone keeps every part of "B" that could meet the curve that "fl" came
+     * from, so only the part that survives both needs to be kept.
+     *
+     * When the curves run nearly parallel, the first clip removes almost
+     * nothing and iterate() would fall back to splitting the curves in half.
+     * The perpendicular clip still shrinks "B" in that case, so we only pay
+     * for it when the first clip wasn't enough.
+     */
+    void clip_fat_lines (Interval& dom,
+                         std::vector<Point> const& B,
+                         FatLine const& fl)
+    {
+        clip_interval(dom, B, fl.line, fl.bound);
+        if (dom == EMPTY_INTERVAL || dom.extent() <= MIN_CLIPPED_SIZE_THRESHOLD)
+            return;
+        
+        Interval perp_dom;
+        clip_interval(perp_dom, B, fl.perp_line, fl.perp_bound);
+        double tmin = std::max(dom.min(), perp_dom.min());
+        double tmax = std::min(dom.max(), perp_dom.max());
+        if (perp_dom == EMPTY_INTERVAL || tmin > tmax)
+        {
+            dom = EMPTY_INTERVAL;
+            return;
+        }
+        dom[0] = tmin;
+        dom[1] = tmax;
+    }
     
     
 #pragma mark - Clipping functions
@@ -857,11 +1023,29 @@ namespace Geom {
                              std::vector<Point> const& B,
                              double precision)
     {
-        std::vector<double> bl(3);
-        Interval bound;
-        pick_orientation_line(bl, A, precision);
-        fat_line_bounds(bound, A, bl);
-        clip_interval(dom, B, bl, bound);
+        FatLine fl;
+        fill_fat_line(fl, A, precision);
+        clip_fat_lines(dom, B, fl);
+    }
+    
+    bool fat_line (FatLine & fl,
+                   std::vector<Point> const& A,
+                   double precision)
+    {
+        // match the precision that iterate() will clip at
+        if (precision < MAX_PRECISION)
+            precision = MAX_PRECISION;
+        if (is_constant(A, precision))
+            return false;
+        fill_fat_line(fl, A, precision);
+        return true;
+    }
+    
+    void clip_with_fat_line (Interval & dom,
+                             FatLine const& fl,
+                             std::vector<Point> const& B)
+    {
+        clip_fat_lines(dom, B, fl);
     }
     
 }
@@ -51,15 +51,34 @@
 # include <ieefp.h>
 #endif
 
-#include <2geom/bezier-utils.h>
+#include "bezier-utils.h"
 
-#include <2geom/isnan.h>
+#include "isnan.h"
 #include <assert.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 namespace Geom{
     
     typedef Point BezierCurve[];
     
+    /*
+     * The per-point loops in reparameterize() and compute_max_error_ratio() dominate fitting
+     * time on dense input, so where the compiler has vector extensions they run
+     * BEZIER_FIT_LANES points at a time, one vector register's worth of doubles (two for
+     * NEON and SSE2, four for AVX).  Leftover points, and other compilers, use the scalar code.
+     */
+#if defined(__clang__) || defined(__GNUC__)
+# ifdef __AVX__
+#  define BEZIER_FIT_LANES 4
+# else
+#  define BEZIER_FIT_LANES 2
+# endif
+    typedef double lane_d __attribute__((vector_size(BEZIER_FIT_LANES * sizeof(double))));
+    typedef decltype(lane_d() < lane_d()) lane_m;
+#endif
+    
     /* Forward declarations */
     static void generate_bezier(Point b[], Point const d[], double const u[], unsigned len,
                                 Point const &tHat1, Point const &tHat2, double tolerance_sq);
@@ -68,15 +87,17 @@ namespace Geom{
                                  Point const &tHat1, Point const &tHat2);
     static void estimate_bi(Point b[4], unsigned ei,
                             Point const data[], double const u[], unsigned len);
-    static void reparameterize(Point const d[], unsigned len, double u[], BezierCurve const bezCurve);
+    static void reparameterize(Point const d[], unsigned len, double u[], BezierCurve const bezCurve,
+                               bool use_lanes);
     static double NewtonRaphsonRootFind(BezierCurve const Q, Point const &P, double u);
+    static void derivative_control_points(BezierCurve const Q, Point Q1[3], Point Q2[2]);
     static Point darray_center_tangent(Point const d[], unsigned center, unsigned length);
     static Point darray_right_tangent(Point const d[], unsigned const len);
     static unsigned copy_without_nans_or_adjacent_duplicates(Point const src[], unsigned src_len, Point dest[]);
     static void chord_length_parameterize(Point const d[], double u[], unsigned len);
     static double compute_max_error_ratio(Point const d[], double const u[], unsigned len,
                                           BezierCurve const bezCurve, double tolerance,
-                                          unsigned *splitPoint);
+                                          unsigned *splitPoint, bool use_lanes);
     static double compute_hook(Point const &a, Point const &b, double const u, BezierCurve const bezCurve,
                                double const tolerance);
     
@@ -124,11 +145,13 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
      *
      * \param max_beziers Maximum number of generated segments
      * \param Result array, must be large enough for n. segments * 4 elements.
+     * \param workspace Optional scratch space to reuse across calls.
      *
      * \return Number of segments generated, or -1 on error.
      */
     int
-    bezier_fit_cubic_r(Point bezier[], Point const data[], int const len, double const error, unsigned const max_beziers)
+    bezier_fit_cubic_r(Point bezier[], Point const data[], int const len, double const error, unsigned const max_beziers,
+                       BezierFitWorkspace *workspace)
     {
         if(bezier == NULL ||
            data == NULL ||
@@ -136,20 +159,22 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
            max_beziers >= (1ul << (31 - 2 - 1 - 3)))
             return -1;
         
-        Point *uniqued_data = new Point[len];
+        BezierFitWorkspace local_workspace;
+        if ( workspace == NULL ) {
+            workspace = &local_workspace;
+        }
+        workspace->reserve(len);
+        Point *uniqued_data = &workspace->uniqued_data[0];
         unsigned uniqued_len = copy_without_nans_or_adjacent_duplicates(data, len, uniqued_data);
         
         if ( uniqued_len < 2 ) {
-            delete[] uniqued_data;
             return 0;
         }
         
         /* Call fit-cubic function with recursion. */
-        int const ret = bezier_fit_cubic_full(bezier, NULL, uniqued_data, uniqued_len,
-                                              unconstrained_tangent, unconstrained_tangent,
-                                              error, max_beziers);
-        delete[] uniqued_data;
-        return ret;
+        return bezier_fit_cubic_full(bezier, NULL, uniqued_data, uniqued_len,
+                                     unconstrained_tangent, unconstrained_tangent,
+                                     error, max_beziers, workspace);
     }
     
     /**
@@ -185,7 +210,124 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
         assert( dest_len <= src_len );
         return dest_len;
     }
-    
+
+    /**
+     * Fit many polylines at once, spreading the strokes across a pool of
+     * threads. Each thread keeps its own workspace, so nothing is
+     * shared between threads until the results are gathered.
+     *
+     * \param bezier Result array, stroke i's segments are stored in
+     *   bezier[4 * segment_offsets[i]] up to bezier[4 * segment_offsets[i + 1]].
+     * \param segment_offsets Filled with \a n_strokes + 1 segment offsets. A stroke
+     *   that can't be fit within \a max_beziers segments gets an empty range.
+     * \param data All input points, with strokes stored back to back.
+     * \param offsets \a n_strokes + 1 offsets into \a data, stroke i is
+     *   data[offsets[i]] up to data[offsets[i + 1]].
+     * \param n_threads Number of threads to use, 0 picks one per core.
+     *
+     * \return Total number of segments generated, or -1 on error.
+     */
+    int
+    bezier_fit_cubic_batch(std::vector<Point> &bezier, std::vector<int> &segment_offsets,
+                           Point const data[], int const offsets[], unsigned const n_strokes,
+                           double const error, unsigned const max_beziers, unsigned n_threads)
+    {
+        bezier.clear();
+        segment_offsets.assign(1, 0);
+        if(data == NULL ||
+           offsets == NULL ||
+           max_beziers < 1 ||
+           max_beziers >= (1ul << (31 - 2 - 1 - 3)))
+            return -1;
+        for (unsigned i = 0; i < n_strokes; ++i) {
+            if ( offsets[i] < 0 || offsets[i + 1] < offsets[i] ) {
+                return -1;
+            }
+        }
+        if ( n_strokes == 0 ) {
+            return 0;
+        }
+
+        if ( n_threads == 0 ) {
+            n_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        n_threads = std::min(n_threads, n_strokes);
+
+        /* Each stroke is fit by exactly one thread, which records where in its own
+         * output its segments landed. */
+        struct StrokeResult {
+            unsigned thread;
+            unsigned start;
+            int count;
+        };
+        std::vector<StrokeResult> results(n_strokes);
+        std::vector<std::vector<Point> > thread_output(n_threads);
+        std::atomic<unsigned> next_stroke(0);
+
+        /* Each worker fits straight into the end of its own output, which is grown
+         * to make room for max_beziers segments and then trimmed back to the segments
+         * found. Its capacity only ever grows, so after the first few strokes no
+         * stroke allocates, and nothing is copied out of a scratch buffer. */
+        auto worker = [&](unsigned const thread) {
+            std::vector<Point> &output = thread_output[thread];
+            BezierFitWorkspace workspace;
+            for (;;) {
+                unsigned const stroke = next_stroke++;
+                if ( stroke >= n_strokes ) {
+                    break;
+                }
+                int const len = offsets[stroke + 1] - offsets[stroke];
+                StrokeResult &result = results[stroke];
+                result.thread = thread;
+                result.start = output.size();
+                result.count = 0;
+                if ( len <= 0 ) {
+                    continue;
+                }
+                output.resize(result.start + max_beziers * 4);
+                int const nsegs = bezier_fit_cubic_r(&output[result.start], data + offsets[stroke], len,
+                                                     error, max_beziers, &workspace);
+                if ( nsegs > 0 ) {
+                    result.count = nsegs;
+                }
+                output.resize(result.start + result.count * 4);
+            }
+        };
+
+        std::vector<std::thread> pool;
+        try {
+            for (unsigned i = 1; i < n_threads; ++i) {
+                pool.push_back(std::thread(worker, i));
+            }
+            worker(0);
+        } catch (...) {
+            /* Destroying a thread that hasn't been joined terminates the process,
+             * so hand out no more strokes and wait for the rest before rethrowing. */
+            next_stroke = n_strokes;
+            for (unsigned i = 0; i < pool.size(); ++i) {
+                pool[i].join();
+            }
+            throw;
+        }
+        for (unsigned i = 0; i < pool.size(); ++i) {
+            pool[i].join();
+        }
+
+        /* Gather the per-thread output back into stroke order. */
+        segment_offsets.resize(n_strokes + 1);
+        for (unsigned i = 0; i < n_strokes; ++i) {
+            segment_offsets[i + 1] = segment_offsets[i] + results[i].count;
+        }
+        bezier.resize(segment_offsets[n_strokes] * 4);
+        for (unsigned i = 0; i < n_strokes; ++i) {
+            std::vector<Point> const &output = thread_output[results[i].thread];
+            std::copy(output.begin() + results[i].start,
+                      output.begin() + results[i].start + results[i].count * 4,
+                      bezier.begin() + segment_offsets[i] * 4);
+        }
+        return segment_offsets[n_strokes];
+    }
+
     /**
      * Fit a multi-segment Bezier curve to a set of digitized points, without
      * possible weedout of identical points and NaNs.
@@ -193,12 +335,14 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
      * \pre data is uniqued, i.e. not exist i: data[i] == data[i + 1].
      * \param max_beziers Maximum number of generated segments
      * \param Result array, must be large enough for n. segments * 4 elements.
+     * \param workspace Optional scratch space, only its parameter buffer is used.
      */
     int
     bezier_fit_cubic_full(Point bezier[], int split_points[],
                           Point const data[], int const len,
                           Point const &tHat1, Point const &tHat2,
-                          double const error, unsigned const max_beziers)
+                          double const error, unsigned const max_beziers,
+                          BezierFitWorkspace *workspace)
     {
         int const maxIterations = 4;   /* std::max times to try iterating */
         
@@ -235,8 +379,18 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
         /*  Parameterize points, and attempt to fit curve */
         unsigned splitPoint;   /* Point to split point set at. */
         bool is_corner;
+        BezierFitWorkspace local_workspace;
+        if ( workspace == NULL ) {
+            workspace = &local_workspace;
+        }
+        
         {
-            double *u = new double[len];
+            /* u is done with before we recurse, so every level of the
+             * recursion shares the same buffer. */
+            if ( workspace->u.size() < unsigned(len) ) {
+                workspace->u.resize(len);
+            }
+            double *u = &workspace->u[0];
             chord_length_parameterize(data, u, len);
             if ( u[len - 1] == 0.0 ) {
                 /* Zero-length path: every point in data[] is the same.
@@ -244,20 +398,18 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
                  * (Clients aren't allowed to pass such data; handling the case is defensive
                  * programming.)
                  */
-                delete[] u;
                 return 0;
             }
             
             generate_bezier(bezier, data, u, len, tHat1, tHat2, error);
-            reparameterize(data, len, u, bezier);
+            reparameterize(data, len, u, bezier, workspace->use_lanes);
             
             /* Find max deviation of points to fitted curve. */
             double const tolerance = sqrt(error + 1e-9);
-            double maxErrorRatio = compute_max_error_ratio(data, u, len, bezier, tolerance, &splitPoint);
+            double maxErrorRatio = compute_max_error_ratio(data, u, len, bezier, tolerance, &splitPoint, workspace->use_lanes);
             
             if ( fabs(maxErrorRatio) <= 1.0 ) {
                 BEZIER_ASSERT(bezier);
-                delete[] u;
                 return 1;
             }
             
@@ -265,16 +417,14 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
             if ( 0.0 <= maxErrorRatio && maxErrorRatio <= 3.0 ) {
                 for (int i = 0; i < maxIterations; i++) {
                     generate_bezier(bezier, data, u, len, tHat1, tHat2, error);
-                    reparameterize(data, len, u, bezier);
-                    maxErrorRatio = compute_max_error_ratio(data, u, len, bezier, tolerance, &splitPoint);
+                    reparameterize(data, len, u, bezier, workspace->use_lanes);
+                    maxErrorRatio = compute_max_error_ratio(data, u, len, bezier, tolerance, &splitPoint, workspace->use_lanes);
                     if ( fabs(maxErrorRatio) <= 1.0 ) {
                         BEZIER_ASSERT(bezier);
-                        delete[] u;
                         return 1;
                     }
                 }
             }
-            delete[] u;
             is_corner = (maxErrorRatio < 0);
         }
         
@@ -286,7 +436,7 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
                     ++splitPoint;
                 } else {
                     return bezier_fit_cubic_full(bezier, split_points, data, len, unconstrained_tangent, tHat2,
-                                                 error, max_beziers);
+                                                 error, max_beziers, workspace);
                 }
             } else if (splitPoint == unsigned(len - 1)) {
                 if (is_zero(tHat2)) {
@@ -294,7 +444,7 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
                     --splitPoint;
                 } else {
                     return bezier_fit_cubic_full(bezier, split_points, data, len, tHat1, unconstrained_tangent,
-                                                 error, max_beziers);
+                                                 error, max_beziers, workspace);
                 }
             }
         }
@@ -316,7 +466,7 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
                 recTHat1 = -recTHat2;
             }
             int const nsegs1 = bezier_fit_cubic_full(bezier, split_points, data, splitPoint + 1,
-                                                     tHat1, recTHat2, error, rec_max_beziers1);
+                                                     tHat1, recTHat2, error, rec_max_beziers1, workspace);
             if ( nsegs1 < 0 ) {
 #ifdef BEZIER_DEBUG
                 g_print("fit_cubic[1]: recursive call failed\n");
@@ -333,7 +483,7 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
                                                       ? NULL
                                                       : split_points + nsegs1 ),
                                                      data + splitPoint, len - splitPoint,
-                                                     recTHat1, tHat2, error, rec_max_beziers2);
+                                                     recTHat1, tHat2, error, rec_max_beziers2, workspace);
             if ( nsegs2 < 0 ) {
 #ifdef BEZIER_DEBUG
                 g_print("fit_cubic[2]: recursive call failed\n");
@@ -531,6 +681,137 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
         }
     }
     
+    /**
+     * Generate the control vertices for Q' and Q'' of the cubic \a Q.
+     */
+    static void
+    derivative_control_points(BezierCurve const Q, Point Q1[3], Point Q2[2])
+    {
+        for (unsigned i = 0; i < 3; i++) {
+            Q1[i] = 3.0 * ( Q[i+1] - Q[i] );
+        }
+        for (unsigned i = 0; i < 2; i++) {
+            Q2[i] = 2.0 * ( Q1[i+1] - Q1[i] );
+        }
+    }
+    
+#ifdef BEZIER_FIT_LANES
+    /*
+     * Lane-wise versions of bezier_pt() and NewtonRaphsonRootFind().  Each lane follows
+     * exactly the same steps as the scalar code, so results only differ by whatever the
+     * compiler does differently with contraction.
+     */
+    
+    static inline lane_d
+    lane_splat(double const x)
+    {
+        lane_d ret;
+        for (unsigned k = 0; k < BEZIER_FIT_LANES; k++) {
+            ret[k] = x;
+        }
+        return ret;
+    }
+    
+    static inline lane_d
+    lane_select(lane_m const mask, lane_d const a, lane_d const b)
+    {
+        return (lane_d) ( ( (lane_m) a & mask ) | ( (lane_m) b & ~mask ) );
+    }
+    
+    static inline bool
+    lane_any(lane_m const mask)
+    {
+        for (unsigned k = 0; k < BEZIER_FIT_LANES; k++) {
+            if (mask[k]) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    static inline void
+    bezier_pt_lanes(unsigned const degree, Point const V[], lane_d const t, lane_d &x, lane_d &y)
+    {
+        static int const pascal[4][4] = {{1},
+            {1, 1},
+            {1, 2, 1},
+            {1, 3, 3, 1}};
+        assert( degree < 4);
+        lane_d const s = lane_splat(1.0) - t;
+        
+        lane_d spow[4];
+        lane_d tpow[4];
+        spow[0] = lane_splat(1.0); spow[1] = s;
+        tpow[0] = lane_splat(1.0); tpow[1] = t;
+        for (unsigned i = 1; i < degree; ++i) {
+            spow[i + 1] = spow[i] * s;
+            tpow[i + 1] = tpow[i] * t;
+        }
+        
+        x = spow[degree] * V[0][X];
+        y = spow[degree] * V[0][Y];
+        for (unsigned i = 1; i <= degree; ++i) {
+            lane_d const w = lane_splat(pascal[degree][i]) * spow[degree - i] * tpow[i];
+            x += w * V[i][X];
+            y += w * V[i][Y];
+        }
+    }
+    
+    static lane_d
+    NewtonRaphsonRootFind_lanes(BezierCurve const Q, Point const Q1[3], Point const Q2[2],
+                                lane_d const px, lane_d const py, lane_d const u)
+    {
+        lane_d Q_ux, Q_uy, Q1_ux, Q1_uy, Q2_ux, Q2_uy;
+        bezier_pt_lanes(3, Q, u, Q_ux, Q_uy);
+        bezier_pt_lanes(2, Q1, u, Q1_ux, Q1_uy);
+        bezier_pt_lanes(1, Q2, u, Q2_ux, Q2_uy);
+        
+        lane_d const diffx = Q_ux - px;
+        lane_d const diffy = Q_uy - py;
+        lane_d const numerator = diffx * Q1_ux + diffy * Q1_uy;
+        lane_d const denominator = ( Q1_ux * Q1_ux + Q1_uy * Q1_uy ) + ( diffx * Q2_ux + diffy * Q2_uy );
+        lane_d const zero = lane_splat(0.0);
+        lane_d const one = lane_splat(1.0);
+        
+        lane_d improved_u = lane_select(numerator < zero, lane_splat(.031) + u * .98, u);
+        improved_u = lane_select(numerator > zero, u * .98 - .01, improved_u);
+        improved_u = lane_select(denominator > zero, u - ( numerator / denominator ), improved_u);
+        
+        /* x - x is only zero when x is finite */
+        improved_u = lane_select(( improved_u - improved_u ) == zero, improved_u, u);
+        improved_u = lane_select(improved_u < zero, zero, improved_u);
+        improved_u = lane_select(improved_u > one, one, improved_u);
+        
+        /* Ensure that improved_u isn't actually worse, backing off only in the lanes that are. */
+        lane_d const diff_lensq = diffx * diffx + diffy * diffy;
+        lane_m backing_off = zero == zero;
+        for (double proportion = .125; ; proportion += .125) {
+            lane_d x, y;
+            bezier_pt_lanes(3, Q, improved_u, x, y);
+            x -= px;
+            y -= py;
+            backing_off &= ( x * x + y * y ) > diff_lensq;
+            if (!lane_any(backing_off)) {
+                break;
+            }
+            if ( proportion > 1.0 ) {
+                improved_u = lane_select(backing_off, u, improved_u);
+                break;
+            }
+            improved_u = lane_select(backing_off,
+                                     ( 1 - proportion ) * improved_u  +  proportion * u,
+                                     improved_u);
+        }
+        
+#ifdef BEZIER_DEBUG
+        for (unsigned k = 0; k < BEZIER_FIT_LANES; k++) {
+            DOUBLE_ASSERT(improved_u[k]);
+        }
+#endif
+        return improved_u;
+    }
+#endif
+    
     /**
      * Given set of points and their parameterization, try to find a better assignment of parameter
      * values for the points.
@@ -545,7 +826,8 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
     reparameterize(Point const d[],
                    unsigned const len,
                    double u[],
-                   BezierCurve const bezCurve)
+                   BezierCurve const bezCurve,
+                   bool const use_lanes)
     {
         assert( 2 <= len );
         
@@ -556,7 +838,27 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
         assert( u[last] == 1.0 );
         /* Otherwise, consider including 0 and last in the below loop. */
         
-        for (unsigned i = 1; i < last; i++) {
+        unsigned i = 1;
+#ifdef BEZIER_FIT_LANES
+        if (use_lanes && BEZIER_FIT_LANES < last) {
+            Point Q1[3];
+            Point Q2[2];
+            derivative_control_points(bezCurve, Q1, Q2);
+            for (; i + BEZIER_FIT_LANES <= last; i += BEZIER_FIT_LANES) {
+                lane_d px, py, lane_u;
+                for (unsigned k = 0; k < BEZIER_FIT_LANES; k++) {
+                    px[k] = d[i + k][X];
+                    py[k] = d[i + k][Y];
+                    lane_u[k] = u[i + k];
+                }
+                lane_u = NewtonRaphsonRootFind_lanes(bezCurve, Q1, Q2, px, py, lane_u);
+                for (unsigned k = 0; k < BEZIER_FIT_LANES; k++) {
+                    u[i + k] = lane_u[k];
+                }
+            }
+        }
+#endif
+        for (; i < last; i++) {
             u[i] = NewtonRaphsonRootFind(bezCurve, d[i], u[i]);
         }
     }
@@ -576,17 +878,9 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
         assert( 0.0 <= u );
         assert( u <= 1.0 );
         
-        /* Generate control vertices for Q'. */
         Point Q1[3];
-        for (unsigned i = 0; i < 3; i++) {
-            Q1[i] = 3.0 * ( Q[i+1] - Q[i] );
-        }
-        
-        /* Generate control vertices for Q''. */
         Point Q2[2];
-        for (unsigned i = 0; i < 2; i++) {
-            Q2[i] = 2.0 * ( Q1[i+1] - Q1[i] );
-        }
+        derivative_control_points(Q, Q1, Q2);
         
         /* Compute Q(u), Q'(u) and Q''(u). */
         Point const Q_u  = bezier_pt(3, Q, u);
@@ -904,7 +1198,7 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
     static double
     compute_max_error_ratio(Point const d[], double const u[], unsigned const len,
                             BezierCurve const bezCurve, double const tolerance,
-                            unsigned *const splitPoint)
+                            unsigned *const splitPoint, bool const use_lanes)
     {
         assert( 2 <= len );
         unsigned const last = len - 1;
@@ -921,7 +1215,58 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
         double max_hook_ratio = 0.0;
         unsigned snap_end = 0;
         Point prev = bezCurve[0];
-        for (unsigned i = 1; i <= last; i++) {
+        unsigned i = 1;
+#ifdef BEZIER_FIT_LANES
+        /* Evaluate the curve in lanes, then reduce in order so that ties pick the same index
+         * as the scalar loop.  Hooks are rare, so the sqrt for them is only taken for the
+         * lanes that are far enough from the curve to need it. */
+        double const tolerance_sq = tolerance * tolerance;
+        for (; use_lanes && i + BEZIER_FIT_LANES <= len; i += BEZIER_FIT_LANES) {
+            lane_d lane_u, mid_u, prevx, prevy;
+            for (unsigned k = 0; k < BEZIER_FIT_LANES; k++) {
+                lane_u[k] = u[i + k];
+                mid_u[k] = .5 * (u[i + k - 1] + u[i + k]);
+            }
+            lane_d currx, curry, hookx, hooky;
+            bezier_pt_lanes(3, bezCurve, lane_u, currx, curry);
+            bezier_pt_lanes(3, bezCurve, mid_u, hookx, hooky);
+            prevx[0] = prev[X];
+            prevy[0] = prev[Y];
+            for (unsigned k = 1; k < BEZIER_FIT_LANES; k++) {
+                prevx[k] = currx[k - 1];
+                prevy[k] = curry[k - 1];
+            }
+            
+            lane_d errx = currx, erry = curry;
+            for (unsigned k = 0; k < BEZIER_FIT_LANES; k++) {
+                errx[k] -= d[i + k][X];
+                erry[k] -= d[i + k][Y];
+            }
+            lane_d const distsq = errx * errx + erry * erry;
+            hookx = ( prevx + currx ) * .5 - hookx;
+            hooky = ( prevy + curry ) * .5 - hooky;
+            lane_d const hook_distsq = hookx * hookx + hooky * hooky;
+            lane_d const chordx = prevx - currx;
+            lane_d const chordy = prevy - curry;
+            lane_d const chord_lensq = chordx * chordx + chordy * chordy;
+            
+            for (unsigned k = 0; k < BEZIER_FIT_LANES; k++) {
+                if ( distsq[k] > maxDistsq ) {
+                    maxDistsq = distsq[k];
+                    *splitPoint = i + k;
+                }
+                if ( hook_distsq[k] >= tolerance_sq ) {
+                    double const hook_ratio = sqrt(hook_distsq[k]) / ( sqrt(chord_lensq[k]) + tolerance );
+                    if (max_hook_ratio < hook_ratio) {
+                        max_hook_ratio = hook_ratio;
+                        snap_end = i + k;
+                    }
+                }
+            }
+            prev = Point(currx[BEZIER_FIT_LANES - 1], curry[BEZIER_FIT_LANES - 1]);
+        }
+#endif
+        for (; i <= last; i++) {
             Point const curr = bezier_pt(3, bezCurve, u[i]);
             double const distsq = lensq( curr - d[i] );
             if ( distsq > maxDistsq ) {
@@ -990,6 +1335,137 @@ DOUBLE_ASSERT((b)[3][X]); DOUBLE_ASSERT((b)[3][Y]);  \
          */
     }
     
+    
+    BezierStreamFitter::BezierStreamFitter(double const error, unsigned const max_tail_points)
+    : error_(error),
+      max_tail_points_(max_tail_points < 3 ? 3 : max_tail_points),
+      has_tail_fit_(false),
+      tHat1_(unconstrained_tangent)
+    {
+    }
+
+    void
+    BezierStreamFitter::reset()
+    {
+        frozen_.clear();
+        tail_.clear();
+        has_tail_fit_ = false;
+        tHat1_ = unconstrained_tangent;
+    }
+
+    /**
+     * Fit the whole open tail with a single cubic, keeping G1 continuity with
+     * the last frozen segment when possible.
+     *
+     * \return 1 on success, 0 if the tail is too short, or -1 if a single
+     *   cubic can't fit the tail within tolerance.
+     */
+    int
+    BezierStreamFitter::fit_tail(Point bezier[4]) const
+    {
+        int const len = tail_.size();
+        if ( len < 2 ) {
+            return 0;
+        }
+        int ret = bezier_fit_cubic_full(bezier, NULL, &tail_[0], len,
+                                        tHat1_, unconstrained_tangent, error_, 1, &workspace_);
+        if ( ret < 0 && !is_zero(tHat1_) ) {
+            /* Allow a corner where the tail joins the frozen segments. */
+            ret = bezier_fit_cubic_full(bezier, NULL, &tail_[0], len,
+                                        unconstrained_tangent, unconstrained_tangent, error_, 1, &workspace_);
+        }
+        return ret;
+    }
+
+    /**
+     * Move the current tail fit to the frozen segments, and restart the tail
+     * at its end point.
+     */
+    void
+    BezierStreamFitter::freeze_tail()
+    {
+        assert( has_tail_fit_ );
+        frozen_.insert(frozen_.end(), tail_fit_, tail_fit_ + 4);
+
+        Point const &end = tail_fit_[3];
+        if ( tail_fit_[2] != end ) {
+            tHat1_ = unit_vector(end - tail_fit_[2]);
+        } else if ( tail_fit_[1] != end ) {
+            tHat1_ = unit_vector(end - tail_fit_[1]);
+        } else {
+            tHat1_ = unconstrained_tangent;
+        }
+
+        tail_.clear();
+        tail_.push_back(end);
+        has_tail_fit_ = false;
+    }
+
+    int
+    BezierStreamFitter::add_point(Point const &p)
+    {
+        if ( IS_NAN(p[X]) || IS_NAN(p[Y]) ) {
+            return 0;
+        }
+        if ( !tail_.empty() && tail_.back() == p ) {
+            return 0;
+        }
+        tail_.push_back(p);
+        if ( tail_.size() < 2 ) {
+            return 0;
+        }
+
+        Point fit[4];
+        int const ret = fit_tail(fit);
+        if ( ret == 0 ) {
+            return 0;
+        }
+        if ( ret > 0 ) {
+            std::copy(fit, fit + 4, tail_fit_);
+            has_tail_fit_ = true;
+            if ( tail_.size() < max_tail_points_ ) {
+                return 0;
+            }
+            /* Tail is as long as we allow, so stop it growing. */
+            freeze_tail();
+            return 1;
+        }
+
+        /* The new point doesn't fit with the rest of the tail, so the
+         * previous fit (which ends at the point before p) can't change
+         * anymore. A two point tail always fits, so it exists. */
+        if ( !has_tail_fit_ ) {
+            return -1;
+        }
+        freeze_tail();
+        tail_.push_back(p);
+        if ( fit_tail(tail_fit_) != 1 ) {
+            return -1;
+        }
+        has_tail_fit_ = true;
+        return 1;
+    }
+
+    int
+    BezierStreamFitter::finish()
+    {
+        if ( !has_tail_fit_ ) {
+            return 0;
+        }
+        freeze_tail();
+        return 1;
+    }
+
+    int
+    BezierStreamFitter::tail_segment(Point bezier[4]) const
+    {
+        if ( !has_tail_fit_ ) {
+            return 0;
+        }
+        std::copy(tail_fit_, tail_fit_ + 4, bezier);
+        return 1;
+    }
+
 }
 
 /*
@@ -41,7 +41,8 @@
  *
  */
 
-#include <2geom/point.h>
+#include "point.h"
+#include <vector>
 
 namespace Geom{
     
@@ -50,12 +51,47 @@ namespace Geom{
     
     int bezier_fit_cubic(Point bezier[], Point const data[], int len, double error);
     
+    /**
+     * Scratch space for the fitting functions. A fit given a workspace
+     * carves all of its temporaries from it, so reusing one workspace
+     * across calls means fits only allocate when they're handed more
+     * points than any earlier fit that used it.
+     *
+     * A workspace must not be used by two fits at the same time.
+     */
+    struct BezierFitWorkspace {
+        std::vector<Point> uniqued_data;
+        std::vector<double> u;
+        
+        /** When false, fits run only the scalar per-point loops, even where the
+         *  compiler has vector extensions.  The results should only differ by
+         *  rounding, which is what this is for checking. */
+        bool use_lanes;
+        
+        BezierFitWorkspace() : use_lanes(true) {}
+        
+        /** Grows the buffers to hold at least \a len points. */
+        void reserve(unsigned len) {
+            if ( uniqued_data.size() < len ) {
+                uniqued_data.resize(len);
+            }
+            if ( u.size() < len ) {
+                u.resize(len);
+            }
+        }
+    };
+    
     int bezier_fit_cubic_r(Point bezier[], Point const data[], int len, double error,
-                           unsigned max_beziers);
+                           unsigned max_beziers, BezierFitWorkspace *workspace = NULL);
     
     int bezier_fit_cubic_full(Point bezier[], int split_points[], Point const data[], int len,
                               Point const &tHat1, Point const &tHat2,
-                              double error, unsigned max_beziers);
+                              double error, unsigned max_beziers,
+                              BezierFitWorkspace *workspace = NULL);
+    
+    int bezier_fit_cubic_batch(std::vector<Point> &bezier, std::vector<int> &segment_offsets,
+                               Point const data[], int const offsets[], unsigned n_strokes,
+                               double error, unsigned max_beziers, unsigned n_threads = 0);
     
     Point darray_left_tangent(Point const d[], unsigned const len);
     Point darray_left_tangent(Point const d[], unsigned const len, double const tolerance_sq);
@@ -83,7 +119,68 @@ namespace Geom{
             }
         }
     }
-    
+
+    /**
+     * Incrementally fits cubic segments to a stream of digitized points.
+     *
+     * Points are fed one at a time with add_point(). Only the open tail
+     * (the points after the last frozen segment) is ever refit, and once
+     * the tail can no longer be fit by a single cubic within \a error,
+     * its previous fit is frozen and a new tail starts at its end point.
+     * Frozen segments are never revisited, and the tail is capped at
+     * \a max_tail_points so the cost per sample stays bounded.
+     *
+     * Consecutive segments share end points, and a new tail is fit with
+     * its initial tangent constrained to the end tangent of the previous
+     * segment unless that makes the fit impossible (i.e. a corner).
+     */
+    class BezierStreamFitter {
+    public:
+        BezierStreamFitter(double error, unsigned max_tail_points = 64);
+
+        /**
+         * Appends a sample, ignoring NaNs and repeats of the previous sample.
+         *
+         * \return Number of segments frozen by this call, or -1 on error.
+         */
+        int add_point(Point const &p);
+
+        /**
+         * Freezes the current tail fit. The fitter can keep accepting
+         * points afterwards, and they will continue from the last point.
+         *
+         * \return Number of segments frozen by this call, or -1 on error.
+         */
+        int finish();
+
+        /** Forgets all points and segments. */
+        void reset();
+
+        /** Number of frozen segments, each stored as 4 points in frozen_segments(). */
+        unsigned frozen_count() const { return frozen_.size() / 4; }
+        Point const *frozen_segments() const { return frozen_.empty() ? NULL : &frozen_[0]; }
+
+        /**
+         * Copies the provisional fit of the open tail into \a bezier.
+         *
+         * \return 1 if the tail has a fit, 0 if it has fewer than 2 points.
+         */
+        int tail_segment(Point bezier[4]) const;
+
+    private:
+        int fit_tail(Point bezier[4]) const;
+        void freeze_tail();
+
+        double error_;
+        unsigned max_tail_points_;
+        std::vector<Point> frozen_;
+        std::vector<Point> tail_;
+        Point tail_fit_[4];
+        bool has_tail_fit_;
+        Point tHat1_;
+        mutable BezierFitWorkspace workspace_;
+    };
+
 }
 #endif /* !SEEN_GEOM_BEZIER_UTILS_H */
 
@@ -0,0 +1,173 @@
+//
+//  MMClippingBezierFittingTests.mm
+//  ClippingBezier
+//
+//  Created by Adam Wulf on 10/17/16.
+//
+//
+
+#import <UIKit/UIKit.h>
+#import "MMClippingBezierAbstractTest.h"
+#include "bezier-utils.h"
+#include "NearestPoint.h"
+#include <vector>
+
+using namespace Geom;
+
+@interface MMClippingBezierFittingTests : MMClippingBezierAbstractTest
+
+@end
+
+@implementation MMClippingBezierFittingTests
+
+// points along a sine wave, like a wavy stroke drawn by a finger
+static std::vector<Point> wavePoints(int count, double phase){
+    std::vector<Point> points;
+    for(int i = 0; i < count; i++){
+        double t = i * 0.05;
+        points.push_back(Point(20 * t, 30 * sin(t + phase)));
+    }
+    return points;
+}
+
+static CGFloat distanceToSegment(Point const& p, Point const* segment){
+    CGPoint bez[4];
+    for(int i = 0; i < 4; i++){
+        bez[i] = CGPointMake(segment[i][X], segment[i][Y]);
+    }
+    CGPoint point = CGPointMake(p[X], p[Y]);
+    CGPoint nearest = NearestPointOnCurve(point, bez, NULL);
+    return sqrt((nearest.x - point.x) * (nearest.x - point.x) + (nearest.y - point.y) * (nearest.y - point.y));
+}
+
+-(void) testStreamingFitMatchesBatchFit{
+    // samples of a single cubic, which both fits
+    // should find as the same single segment
+    Point curve[4] = { Point(0, 0), Point(30, 40), Point(70, 40), Point(100, 0) };
+    std::vector<Point> points;
+    for(int i = 0; i <= 20; i++){
+        double t = i / 20.0;
+        double mt = 1 - t;
+        points.push_back(mt * mt * mt * curve[0] + 3 * mt * mt * t * curve[1] + 3 * mt * t * t * curve[2] + t * t * t * curve[3]);
+    }
+
+    BezierStreamFitter fitter(1.0);
+    for(Point const& p : points){
+        XCTAssertTrue(fitter.add_point(p) >= 0, @"point was added");
+    }
+    fitter.finish();
+
+    Point batch[4];
+    XCTAssertEqual(bezier_fit_cubic_r(batch, &points[0], (int)points.size(), 1.0, 1), 1, @"batch found one segment");
+    XCTAssertEqual(fitter.frozen_count(), 1u, @"stream found one segment");
+
+    Point const* streamed = fitter.frozen_segments();
+    for(int i = 0; i < 4; i++){
+        XCTAssertEqualWithAccuracy(streamed[i][X], batch[i][X], 0.0001, @"segments match");
+        XCTAssertEqualWithAccuracy(streamed[i][Y], batch[i][Y], 0.0001, @"segments match");
+    }
+}
+
+-(void) testStreamingFitNeverChangesFrozenSegments{
+    std::vector<Point> points = wavePoints(400, 0);
+
+    BezierStreamFitter fitter(0.25);
+    std::vector<Point> previouslyFrozen;
+    for(Point const& p : points){
+        XCTAssertTrue(fitter.add_point(p) >= 0, @"point was added");
+        Point const* frozen = fitter.frozen_segments();
+        XCTAssertTrue(fitter.frozen_count() * 4 >= previouslyFrozen.size(), @"segments are never removed");
+        for(size_t i = 0; i < previouslyFrozen.size(); i++){
+            XCTAssertTrue(frozen[i] == previouslyFrozen[i], @"frozen segments never change");
+        }
+        previouslyFrozen.assign(frozen, frozen + fitter.frozen_count() * 4);
+    }
+    fitter.finish();
+
+    unsigned count = fitter.frozen_count();
+    Point const* segments = fitter.frozen_segments();
+    XCTAssertTrue(count > 1, @"the wave needs several segments");
+    XCTAssertTrue(segments[0] == points.front(), @"starts at the first point");
+    XCTAssertTrue(segments[count * 4 - 1] == points.back(), @"ends at the last point");
+    for(unsigned i = 1; i < count; i++){
+        XCTAssertTrue(segments[i * 4] == segments[i * 4 - 1], @"segments are connected");
+    }
+
+    // the same tolerance that a batch fit keeps to
+    for(Point const& p : points){
+        CGFloat closest = CGFLOAT_MAX;
+        for(unsigned i = 0; i < count; i++){
+            closest = MIN(closest, distanceToSegment(p, segments + i * 4));
+        }
+        XCTAssertTrue(closest <= 0.5 + 0.01, @"point is within the error");
+    }
+}
+
+-(void) testBatchFitMatchesFittingEachStroke{
+    // strokes of different lengths, so the threads
+    // finish them in a different order than they start
+    std::vector<Point> points;
+    std::vector<int> offsets(1, 0);
+    for(int i = 0; i < 6; i++){
+        std::vector<Point> stroke = wavePoints(50 + 30 * i, i);
+        points.insert(points.end(), stroke.begin(), stroke.end());
+        offsets.push_back((int)points.size());
+    }
+
+    std::vector<Point> beziers;
+    std::vector<int> segmentOffsets;
+    int total = bezier_fit_cubic_batch(beziers, segmentOffsets, &points[0], &offsets[0], 6, 0.25, 64, 3);
+    XCTAssertEqual(segmentOffsets.size(), (size_t)7, @"an offset for each stroke");
+    XCTAssertEqual(total, segmentOffsets[6], @"found every segment");
+
+    for(int i = 0; i < 6; i++){
+        std::vector<Point> single(4 * 64);
+        int count = bezier_fit_cubic_r(&single[0], &points[offsets[i]], offsets[i + 1] - offsets[i], 0.25, 64);
+        XCTAssertEqual(count, segmentOffsets[i + 1] - segmentOffsets[i], @"same number of segments");
+        for(int j = 0; j < 4 * count; j++){
+            XCTAssertTrue(single[j] == beziers[4 * segmentOffsets[i] + j], @"same segments");
+        }
+    }
+}
+
+-(void) testReusedWorkspaceFitsTheSame{
+    // the longest stroke first, so later fits reuse buffers
+    // that still hold the points of the fits before them
+    BezierFitWorkspace workspace;
+    for(int i = 5; i >= 0; i--){
+        std::vector<Point> points = wavePoints(50 + 30 * i, i);
+        std::vector<Point> reused(4 * 64);
+        std::vector<Point> fresh(4 * 64);
+        int reusedCount = bezier_fit_cubic_r(&reused[0], &points[0], (int)points.size(), 0.25, 64, &workspace);
+        int freshCount = bezier_fit_cubic_r(&fresh[0], &points[0], (int)points.size(), 0.25, 64);
+        XCTAssertTrue(reusedCount > 0, @"found segments");
+        XCTAssertEqual(reusedCount, freshCount, @"same number of segments");
+        for(int j = 0; j < 4 * reusedCount; j++){
+            XCTAssertTrue(reused[j] == fresh[j], @"same segments");
+        }
+    }
+}
+
+-(void) testLanesFitTheSameAsScalarCode{
+    // odd lengths leave a tail of points after the last full
+    // group of lanes, whether there are two or four lanes
+    int lengths[] = { 5, 7, 101, 403 };
+    for(int length : lengths){
+        std::vector<Point> points = wavePoints(length, length);
+        BezierFitWorkspace lanes;
+        BezierFitWorkspace scalar;
+        scalar.use_lanes = false;
+        std::vector<Point> laneFit(4 * 64);
+        std::vector<Point> scalarFit(4 * 64);
+        int laneCount = bezier_fit_cubic_r(&laneFit[0], &points[0], length, 0.25, 64, &lanes);
+        int scalarCount = bezier_fit_cubic_r(&scalarFit[0], &points[0], length, 0.25, 64, &scalar);
+        XCTAssertTrue(laneCount > 0, @"found segments");
+        XCTAssertEqual(laneCount, scalarCount, @"same number of segments");
+        for(int j = 0; j < 4 * MIN(laneCount, scalarCount); j++){
+            XCTAssertEqualWithAccuracy(laneFit[j][X], scalarFit[j][X], 0.000001, @"same control points");
+            XCTAssertEqualWithAccuracy(laneFit[j][Y], scalarFit[j][Y], 0.000001, @"same control points");
+        }
+    }
+}
+
+@end
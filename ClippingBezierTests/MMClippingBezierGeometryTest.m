@@ -48,4 +48,175 @@
 }
 
 
+
+-(void) testPointWithinDistanceOfPath{
+    UIBezierPath* path = [UIBezierPath bezierPathWithOvalInRect:CGRectMake(100, 100, 200, 200)];
+    [path appendPath:[UIBezierPath bezierPathWithRect:CGRectMake(400, 100, 100, 100)]];
+
+    XCTAssertTrue([path isPoint:CGPointMake(200, 95) withinDistance:10], @"near the top of the circle");
+    XCTAssertFalse([path isPoint:CGPointMake(200, 200) withinDistance:10], @"the center is far from the circle");
+    XCTAssertTrue([path isPoint:CGPointMake(395, 150) withinDistance:10], @"near the closing edge of the square");
+    XCTAssertFalse([path isPoint:CGPointMake(1000, 1000) withinDistance:10], @"far from everything");
+
+    // the batch form agrees with the distance to the closest point
+    UIBezierPath* circle = [UIBezierPath bezierPathWithOvalInRect:CGRectMake(100, 100, 200, 200)];
+    CGPoint points[100];
+    for(int i = 0; i < 100; i++){
+        points[i] = CGPointMake(80 + (i % 10) * 27, 80 + (i / 10) * 27);
+    }
+    BOOL results[100];
+    [circle arePoints:points count:100 withinDistance:15 results:results];
+    for(int i = 0; i < 100; i++){
+        XCTAssertEqual(results[i], [circle isPoint:points[i] withinDistance:15], @"batch matches single points");
+        CGFloat dist = distance(points[i], [circle closestPointOnPathTo:points[i]]);
+        if(dist < 14.9){
+            XCTAssertTrue(results[i], @"point is within the radius");
+        }else if(dist > 15.1){
+            XCTAssertFalse(results[i], @"point is outside the radius");
+        }
+    }
+}
+
+-(void) testClosestDistanceBetweenPaths{
+    UIBezierPath* circle1 = [UIBezierPath bezierPathWithOvalInRect:CGRectMake(50, 50, 100, 100)];
+    UIBezierPath* circle2 = [UIBezierPath bezierPathWithOvalInRect:CGRectMake(200, 50, 100, 100)];
+
+    NSInteger index1, index2;
+    CGFloat tValue1, tValue2;
+    CGFloat dist = [circle1 closestDistanceToPath:circle2 atIndex:&index1 andElementTValue:&tValue1 otherIndex:&index2 andOtherElementTValue:&tValue2];
+    XCTAssertEqualWithAccuracy(dist, 50, 0.01, @"circles are 50 apart");
+
+    // the points are only found to within the distance's precision,
+    // and they slide along the curves much faster than it changes
+    CGPoint p1 = [circle1 pointOnPathAtElement:index1 andTValue:tValue1];
+    CGPoint p2 = [circle2 pointOnPathAtElement:index2 andTValue:tValue2];
+    XCTAssertEqualWithAccuracy(distance(p1, p2), dist, 0.01, @"the points are as far apart as the distance");
+    XCTAssertEqualWithAccuracy(p1.x, 150, 0.1, @"closest point on the first circle");
+    XCTAssertEqualWithAccuracy(p1.y, 100, 1.5, @"closest point on the first circle");
+    XCTAssertEqualWithAccuracy(p2.x, 200, 0.1, @"closest point on the second circle");
+    XCTAssertEqualWithAccuracy(p2.y, 100, 1.5, @"closest point on the second circle");
+
+    XCTAssertTrue([circle1 isWithinDistance:51 ofPath:circle2], @"within 51");
+    XCTAssertFalse([circle1 isWithinDistance:49 ofPath:circle2], @"not within 49");
+
+    UIBezierPath* line = [UIBezierPath bezierPath];
+    [line moveToPoint:CGPointMake(0, 0)];
+    [line addLineToPoint:CGPointMake(300, 300)];
+    XCTAssertEqualWithAccuracy([circle1 closestDistanceToPath:line atIndex:nil andElementTValue:nil otherIndex:nil andOtherElementTValue:nil], 0, 0.01, @"the line crosses the circle");
+    XCTAssertTrue([line isWithinDistance:0 ofPath:circle1], @"the line crosses the first circle");
+    XCTAssertTrue([circle1 isWithinDistance:0.001 ofPath:line], @"the circle crosses the line");
+    XCTAssertFalse([line isWithinDistance:0 ofPath:circle2], @"the line misses the second circle");
+
+    UIBezierPath* empty = [UIBezierPath bezierPath];
+    XCTAssertEqual([circle1 closestDistanceToPath:empty atIndex:&index1 andElementTValue:nil otherIndex:&index2 andOtherElementTValue:nil], CGFLOAT_MAX, @"nothing to measure");
+    XCTAssertEqual(index1, -1, @"no element");
+    XCTAssertFalse([circle1 isWithinDistance:1000 ofPath:empty], @"nothing to be near");
+}
+
+-(void) testSimplifyFlattenedCircle{
+    // a circle drawn as 200 short lines should refit to just
+    // a handful of curves
+    UIBezierPath* flattened = [UIBezierPath bezierPath];
+    [flattened moveToPoint:CGPointMake(600, 500)];
+    for(int i=1;i<=200;i++){
+        CGFloat angle = M_PI * 2 * i / 200;
+        [flattened addLineToPoint:CGPointMake(500 + 100 * cos(angle), 500 + 100 * sin(angle))];
+    }
+
+    NSArray* mapping = nil;
+    UIBezierPath* simplified = [flattened bezierPathBySimplifyingWithTolerance:.5 andCornerAngle:M_PI / 6 elementMapping:&mapping];
+
+    XCTAssertTrue([simplified elementCount] < 20, @"circle was simplified");
+    XCTAssertEqual([mapping count], [simplified elementCount], @"every element is mapped");
+
+    // the mapping covers every original element, in order
+    NSUInteger nextElement = 0;
+    for(NSValue* val in mapping){
+        NSRange range = [val rangeValue];
+        XCTAssertEqual(range.location, nextElement, @"mapping is contiguous");
+        nextElement = NSMaxRange(range);
+    }
+    XCTAssertEqual(nextElement, (NSUInteger)[flattened elementCount], @"mapping covers every element");
+
+    for(int i=0;i<200;i+=7){
+        CGFloat angle = M_PI * 2 * i / 200;
+        CGPoint p = CGPointMake(500 + 100 * cos(angle), 500 + 100 * sin(angle));
+        CGPoint closest = [simplified closestPointOnPathTo:p];
+        XCTAssertTrue([self check:distance(p, closest) isLessThan:.5 within:.1], @"stays within tolerance");
+    }
+}
+
+-(void) testSimplifiedClippingMapsElementsToOriginalPath{
+    // a flattened scissor, drawn as many short lines
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(100, 250)];
+    for(int i=1;i<=100;i++){
+        CGFloat x = 100 + 4 * i;
+        [scissorPath addLineToPoint:CGPointMake(x, 250 + 40 * sin((x - 100) / 60))];
+    }
+    UIBezierPath* closedPath = [UIBezierPath bezierPathWithRect:CGRectMake(200, 200, 200, 200)];
+
+    DKUIBezierPathClippingOptions* options = [DKUIBezierPathClippingOptions defaultOptions];
+    options.simplificationTolerance = .5;
+    NSArray* mapping = nil;
+    NSArray* closedMapping = nil;
+    DKUIBezierPathClippingResult* result = [scissorPath clipToClosedPath:closedPath withOptions:options elementMapping:&mapping andClosedPathElementMapping:&closedMapping];
+
+    XCTAssertTrue([mapping count] < [scissorPath elementCount], @"the scissor was simplified");
+    XCTAssertEqual([closedMapping count], (NSUInteger)[closedPath elementCount], @"the rect has nothing to simplify");
+    XCTAssertTrue([result.intersectionSegments count] > 0, @"found segments");
+    for(DKUIBezierPathClippedSegment* segment in [result.intersectionSegments arrayByAddingObjectsFromArray:result.differenceSegments]){
+        for(DKUIBezierPathIntersectionPoint* intersection in @[segment.startIntersection, segment.endIntersection]){
+            XCTAssertTrue(intersection.elementIndex1 < (NSInteger)[mapping count], @"the element is in the mapping");
+            NSRange range = [[mapping objectAtIndex:intersection.elementIndex1] rangeValue];
+            XCTAssertTrue(NSMaxRange(range) <= (NSUInteger)[scissorPath elementCount], @"the mapping is in the original scissor");
+        }
+    }
+
+    // without simplification, every element maps to itself
+    [scissorPath clipToClosedPath:closedPath withOptions:nil elementMapping:&mapping andClosedPathElementMapping:nil];
+    XCTAssertEqual([mapping count], (NSUInteger)[scissorPath elementCount], @"nothing was simplified");
+    XCTAssertEqual([[mapping lastObject] rangeValue].location, (NSUInteger)[scissorPath elementCount] - 1, @"elements map to themselves");
+}
+
+-(void) testSimplifyKeepsCorners{
+    UIBezierPath* square = [UIBezierPath bezierPathWithRect:CGRectMake(100, 100, 200, 200)];
+
+    UIBezierPath* simplified = [square bezierPathBySimplifyingWithTolerance:.5 andCornerAngle:M_PI / 6 elementMapping:nil];
+
+    XCTAssertEqual([simplified elementCount], [square elementCount], @"square has nothing to simplify");
+    XCTAssertTrue(CGRectEqualToRect([simplified bounds], [square bounds]), @"bounds are the same");
+}
+
+-(void) testScanlineCrossingsOfCircleAndSquare{
+    UIBezierPath* path = [UIBezierPath bezierPathWithOvalInRect:CGRectMake(0, 0, 200, 200)];
+    [path appendPath:[UIBezierPath bezierPathWithRect:CGRectMake(50, 50, 100, 100)]];
+
+    CGFloat yValues[] = { 100, 10, 150, 300 };
+    __block NSUInteger calls = 0;
+    [path enumerateScanlineCrossingsAtYValues:yValues count:4 usingBlock:^(NSUInteger index, const DKScanlineCrossing* crossings, NSUInteger crossingCount){
+        calls++;
+        CGFloat y = yValues[index];
+        if(y == 100){
+            XCTAssertEqual(crossingCount, (NSUInteger)4, @"crosses the circle and the square");
+            XCTAssertTrue([self check:crossings[0].x isEqualTo:0 within:.01], @"left of circle");
+            XCTAssertTrue([self check:crossings[1].x isEqualTo:50 within:.01], @"left of square");
+            XCTAssertTrue([self check:crossings[2].x isEqualTo:150 within:.01], @"right of square");
+            XCTAssertTrue([self check:crossings[3].x isEqualTo:200 within:.01], @"right of circle");
+            XCTAssertEqual(crossings[0].winding, -crossings[3].winding, @"circle winds one way");
+            XCTAssertEqual(crossings[1].winding, -crossings[2].winding, @"square winds one way");
+        }else if(y == 10){
+            XCTAssertEqual(crossingCount, (NSUInteger)2, @"only crosses the circle");
+            XCTAssertTrue([self check:crossings[0].x + crossings[1].x isEqualTo:200 within:.01], @"crossings are symmetric");
+        }else if(y == 150){
+            // the bottom edge of the square is horizontal, and the
+            // scanline is at the bottom of the square's sides
+            XCTAssertEqual(crossingCount, (NSUInteger)2, @"only crosses the circle");
+        }else{
+            XCTAssertEqual(crossingCount, (NSUInteger)0, @"misses the path");
+        }
+    }];
+    XCTAssertEqual(calls, (NSUInteger)4, @"called once per scanline");
+}
+
 @end
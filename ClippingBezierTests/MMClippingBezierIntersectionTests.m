@@ -181,6 +181,134 @@
     XCTAssertTrue([self point:[[otherIntersections objectAtIndex:1] location1] isNearTo:[[otherIntersections objectAtIndex:1] location2]], @"locations match");
 }
 
+-(void) testCurveBoundsSkipControlPointHull{
+    // the curve's control points reach y=200, but the
+    // curve itself only reaches y=150, so it should never
+    // be compared to the line at y=180
+    UIBezierPath* curvePath = [UIBezierPath bezierPath];
+    [curvePath moveToPoint:CGPointMake(0, 0)];
+    [curvePath addCurveToPoint:CGPointMake(200, 0) controlPoint1:CGPointMake(0, 200) controlPoint2:CGPointMake(200, 200)];
+    
+    UIBezierPath* linePath = [UIBezierPath bezierPath];
+    [linePath moveToPoint:CGPointMake(-50, 180)];
+    [linePath addLineToPoint:CGPointMake(250, 180)];
+    
+    [UIBezierPath resetSegmentCompareCount];
+    NSArray* intersections = [curvePath findIntersectionsWithClosedPath:linePath andBeginsInside:nil];
+    
+    XCTAssertEqual([intersections count], (NSUInteger) 0, @"the curves don't intersect");
+    XCTAssertEqual([UIBezierPath segmentCompareCount], (NSInteger) 0, @"no elements were compared");
+}
+
+-(void) testControlHullsSkipOverlappingBounds{
+    // the bounds of these two parallel diagonals
+    // overlap, but the lines are ~35px apart
+    UIBezierPath* path1 = [UIBezierPath bezierPath];
+    [path1 moveToPoint:CGPointMake(0, 0)];
+    [path1 addCurveToPoint:CGPointMake(100, 100) controlPoint1:CGPointMake(30, 30) controlPoint2:CGPointMake(70, 70)];
+    
+    UIBezierPath* path2 = [UIBezierPath bezierPath];
+    [path2 moveToPoint:CGPointMake(50, 0)];
+    [path2 addLineToPoint:CGPointMake(100, 50)];
+    
+    [UIBezierPath resetSegmentCompareCount];
+    [UIBezierPath resetSegmentHullRejectCount];
+    NSArray* intersections = [path1 findIntersectionsWithClosedPath:path2 andBeginsInside:nil];
+    
+    XCTAssertEqual([intersections count], (NSUInteger) 0, @"the curves don't intersect");
+    XCTAssertEqual([UIBezierPath segmentHullRejectCount], (NSInteger) 1, @"the hulls are apart");
+    XCTAssertEqual([UIBezierPath segmentCompareCount], (NSInteger) 0, @"no elements were compared");
+}
+
+-(void) testNearlyParallelCurvesSplitLess{
+    // these curves run within a few px of each other,
+    // and cross once in the middle
+    UIBezierPath* path1 = [UIBezierPath bezierPath];
+    [path1 moveToPoint:CGPointMake(0, 0)];
+    [path1 addCurveToPoint:CGPointMake(300, 0) controlPoint1:CGPointMake(100, 20) controlPoint2:CGPointMake(200, 20)];
+    
+    UIBezierPath* path2 = [UIBezierPath bezierPath];
+    [path2 moveToPoint:CGPointMake(0, 2)];
+    [path2 addCurveToPoint:CGPointMake(300, -2) controlPoint1:CGPointMake(100, 19) controlPoint2:CGPointMake(200, 21)];
+    
+    [UIBezierPath resetSegmentSplitCount];
+    NSArray* intersections = [path1 findIntersectionsWithClosedPath:path2 andBeginsInside:nil];
+    
+    XCTAssertEqual([intersections count], (NSUInteger) 1, @"the curves cross once");
+    XCTAssertTrue([self point:[[intersections firstObject] location1] isNearTo:CGPointMake(150, 15)], @"found the crossing");
+    // clipping against only the parallel fat line needs 21 splits
+    XCTAssertLessThan([UIBezierPath segmentSplitCount], (NSInteger) 21, @"the perpendicular fat line clipped the curves");
+}
+
+-(void) testOverlappingCurvesFindOnlyOverlapEnds{
+    // path2 is the middle of path1's curve, from t=.25 to t=.75,
+    // so the two curves share that whole stretch
+    UIBezierPath* path1 = [UIBezierPath bezierPath];
+    [path1 moveToPoint:CGPointMake(0, 0)];
+    [path1 addCurveToPoint:CGPointMake(400, 0) controlPoint1:CGPointMake(100, 200) controlPoint2:CGPointMake(300, -200)];
+    
+    UIBezierPath* path2 = [UIBezierPath bezierPath];
+    [path2 moveToPoint:CGPointMake(90.625, 56.25)];
+    [path2 addCurveToPoint:CGPointMake(309.375, -56.25) controlPoint1:CGPointMake(159.375, 43.75) controlPoint2:CGPointMake(240.625, -43.75)];
+    
+    [UIBezierPath resetSegmentOverlapCount];
+    NSArray* intersections = [path1 findIntersectionsWithClosedPath:path2 andBeginsInside:nil];
+    
+    XCTAssertEqual([UIBezierPath segmentOverlapCount], (NSInteger) 1, @"found the overlap");
+    XCTAssertEqual([intersections count], (NSUInteger) 2, @"only the ends of the overlap");
+    XCTAssertEqualWithAccuracy([[intersections firstObject] tValue1], .25, 0.001, @"overlap starts at the start of path2");
+    XCTAssertEqualWithAccuracy([[intersections lastObject] tValue1], .75, 0.001, @"overlap ends at the end of path2");
+}
+
+-(void) testIntersectionCacheFindsSameIntersections{
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(150, 150)];
+    [scissorPath addCurveToPoint:CGPointMake(450, 450) controlPoint1:CGPointMake(400, 100) controlPoint2:CGPointMake(100, 400)];
+    
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithOvalInRect:CGRectMake(200, 200, 200, 200)];
+    
+    NSArray* uncachedIntersections = [scissorPath findIntersectionsWithClosedPath:shapePath andBeginsInside:nil];
+    
+    [UIBezierPath setIntersectionCacheCapacity:100];
+    [UIBezierPath resetSegmentCacheHitCount];
+    [UIBezierPath resetSegmentCacheMissCount];
+    [scissorPath findIntersectionsWithClosedPath:shapePath andBeginsInside:nil];
+    NSInteger missCount = [UIBezierPath segmentCacheMissCount];
+    NSArray* cachedIntersections = [scissorPath findIntersectionsWithClosedPath:shapePath andBeginsInside:nil];
+    
+    XCTAssertTrue(missCount > 0, @"the first search fills the cache");
+    XCTAssertEqual([UIBezierPath segmentCacheMissCount], missCount, @"the second search never misses");
+    XCTAssertEqual([UIBezierPath segmentCacheHitCount], missCount, @"the second search hits every pair");
+    
+    XCTAssertEqual([cachedIntersections count], [uncachedIntersections count], @"same intersections");
+    for(int i=0;i<[cachedIntersections count];i++){
+        XCTAssertEqual([[cachedIntersections objectAtIndex:i] elementIndex1], [[uncachedIntersections objectAtIndex:i] elementIndex1], @"same intersections");
+        XCTAssertEqual([[cachedIntersections objectAtIndex:i] tValue1], [[uncachedIntersections objectAtIndex:i] tValue1], @"same intersections");
+    }
+    
+    [UIBezierPath setIntersectionCacheCapacity:0];
+}
+
+-(void) testFlippedIntersectionsStillMatch{
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(300.0, 50.0)];
+    [scissorPath addLineToPoint:CGPointMake(300.0,600.0)];
+    
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(200, 200, 200, 200)];
+    
+    NSArray* intersections = [scissorPath findIntersectionsWithClosedPath:shapePath andBeginsInside:nil];
+    XCTAssertEqual([intersections count], (NSUInteger) 2, @"the curves do intersect");
+    
+    DKUIBezierPathIntersectionPoint* first = [intersections firstObject];
+    DKUIBezierPathIntersectionPoint* last = [intersections lastObject];
+    XCTAssertTrue([[[first flipped] flipped] isEqualToIntersection:first], @"flipping twice is the same intersection");
+    XCTAssertFalse([[[first flipped] flipped] isEqualToIntersection:last], @"different intersections don't match");
+    XCTAssertTrue([first crossMatchesIntersection:[first flipped]], @"cross matches its flipped copy");
+    XCTAssertFalse([first crossMatchesIntersection:[last flipped]], @"doesn't cross match other intersections");
+    XCTAssertTrue([[first flipped] matchesElementEndpointWithIntersection:[first flipped]], @"matches itself");
+    XCTAssertEqualObjects([NSSet setWithObject:first], [NSSet setWithObject:[[first flipped] flipped]], @"sets see the same intersection");
+}
+
 -(void) testFindingIntersectionsForVerticalTangentLines{
     // there is a TODO in UIBezierPath+Clipping.m to handle tangent lines
     XCTAssertTrue(NO, @"functionality needs defining");
@@ -1362,4 +1490,26 @@
 
 }
 
+-(void) testIntersectionWithQuadCurve{
+    
+    // the quad curve peaks at (50, 50), so the scissor
+    // needs to cross it there and not at the peak of a
+    // cubic with both control points at (50, 100)
+    UIBezierPath* shapePath = [UIBezierPath bezierPath];
+    [shapePath moveToPoint:CGPointMake(0, 0)];
+    [shapePath addQuadCurveToPoint:CGPointMake(100, 0) controlPoint:CGPointMake(50, 100)];
+    [shapePath closePath];
+    
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(50, -10)];
+    [scissorPath addLineToPoint:CGPointMake(50, 100)];
+    
+    NSArray* intersections = [scissorPath findIntersectionsWithClosedPath:shapePath andBeginsInside:nil];
+    
+    XCTAssertEqual([intersections count], (NSUInteger)2, @"found intersections");
+    XCTAssertTrue([self point:[[intersections objectAtIndex:0] location1] isNearTo:CGPointMake(50, 0)], @"crosses the closing line");
+    XCTAssertTrue([self point:[[intersections objectAtIndex:1] location1] isNearTo:CGPointMake(50, 50)], @"crosses the quad curve");
+    XCTAssertTrue([self point:[[intersections objectAtIndex:1] location2] isNearTo:CGPointMake(50, 50)], @"crosses the quad curve");
+}
+
 @end
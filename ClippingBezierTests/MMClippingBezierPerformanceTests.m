@@ -46,6 +46,25 @@
 }
 
 
+-(void) testPerformanceOfSimplifyingLongStrokes{
+    // a long wavy stroke of short line segments, like
+    // what comes in from a finger or pencil
+    UIBezierPath* stroke = [UIBezierPath bezierPath];
+    [stroke moveToPoint:CGPointMake(0, 500)];
+    for(int i=1;i<5000;i++){
+        CGFloat t = i / 10.0;
+        [stroke addLineToPoint:CGPointMake(t * 2 + 30 * sin(t * .7), 500 + 200 * cos(t * .31) + 5 * sin(t * 3.1))];
+    }
+
+    __block UIBezierPath* simplified = nil;
+    [self measureBlock:^{
+        simplified = [stroke bezierPathBySimplifyingWithTolerance:.5 andCornerAngle:M_PI / 6 elementMapping:nil];
+    }];
+
+    XCTAssertTrue([simplified elementCount] < [stroke elementCount] / 2, @"stroke was simplified");
+}
+
+
 
 #pragma mark - Helpers
 
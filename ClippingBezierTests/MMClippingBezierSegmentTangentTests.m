@@ -61,6 +61,74 @@
 }
 
 
+-(void) testReversedSegmentTangentsMatchReversedPath{
+    
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(0, 50)];
+    [scissorPath addCurveToPoint:CGPointMake(200, 90) controlPoint1:CGPointMake(60, 0) controlPoint2:CGPointMake(120, 160)];
+    
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(50, 0, 100, 150)];
+    
+    NSArray* allSegments = [UIBezierPath redAndBlueSegmentsForShapeBuildingCreatedFrom:shapePath bySlicingWithPath:scissorPath andNumberOfBlueShellSegments:nil];
+    NSArray* redSegments = [allSegments firstObject];
+    XCTAssertTrue([redSegments count] > 0, @"found segments");
+    
+    for(DKUIBezierPathClippedSegment* redSegment in redSegments){
+        // the reversed segment's tangents are found without its path,
+        // so check them against a segment made from the path itself
+        DKUIBezierPathClippedSegment* reversed = [redSegment reversedSegment];
+        DKVector* startVector = [reversed startVector];
+        DKVector* endVector = [reversed endVector];
+        UIBezierPath* reversedPath = [reversed pathSegment];
+        XCTAssertTrue(CGPointEqualToPoint([reversedPath firstPoint], [redSegment.pathSegment lastPoint]), @"path is reversed");
+        DKUIBezierPathClippedSegment* fromPath = [DKUIBezierPathClippedSegment clippedPairWithStart:reversed.startIntersection
+                                                                                             andEnd:reversed.endIntersection
+                                                                                     andPathSegment:reversedPath
+                                                                                       fromFullPath:reversed.fullPath];
+        XCTAssertEqualWithAccuracy(startVector.x, [fromPath startVector].x, 0.0001, @"start tangent matches");
+        XCTAssertEqualWithAccuracy(startVector.y, [fromPath startVector].y, 0.0001, @"start tangent matches");
+        XCTAssertEqualWithAccuracy(endVector.x, [fromPath endVector].x, 0.0001, @"end tangent matches");
+        XCTAssertEqualWithAccuracy(endVector.y, [fromPath endVector].y, 0.0001, @"end tangent matches");
+    }
+}
+
+-(void) testSegmentTangentsSkipDegenerateElements{
+
+    // the path starts with a line that goes nowhere, and then a curve
+    // whose first control point is on top of its start, so it leaves
+    // towards its second control point. it ends with a curve whose
+    // last control point is on top of its end, and then another line
+    // that goes nowhere
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(0, 0)];
+    [scissorPath addLineToPoint:CGPointMake(0, 0)];
+    [scissorPath addCurveToPoint:CGPointMake(100, 100) controlPoint1:CGPointMake(0, 0) controlPoint2:CGPointMake(100, 0)];
+    [scissorPath addCurveToPoint:CGPointMake(200, 100) controlPoint1:CGPointMake(100, 200) controlPoint2:CGPointMake(200, 100)];
+    [scissorPath addLineToPoint:CGPointMake(200, 100)];
+
+    DKUIBezierPathClippedSegment* segment = [DKUIBezierPathClippedSegment clippedPairWithStart:nil andEnd:nil andPathSegment:scissorPath fromFullPath:scissorPath];
+    XCTAssertEqualWithAccuracy([segment startVector].x, 1, 0.0001, @"leaves towards the second control point");
+    XCTAssertEqualWithAccuracy([segment startVector].y, 0, 0.0001, @"leaves towards the second control point");
+    XCTAssertEqualWithAccuracy([segment endVector].x, sqrt(0.5), 0.0001, @"arrives from the second control point");
+    XCTAssertEqualWithAccuracy([segment endVector].y, -sqrt(0.5), 0.0001, @"arrives from the second control point");
+
+    // the square cuts the last curve in half, so
+    // the segments each have one degenerate end
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(150, 0, 100, 200)];
+    DKUIBezierPathClippingResult* result = [scissorPath clipToClosedPath:shapePath withOptions:nil];
+    XCTAssertEqual([[result differenceSegments] count], (NSUInteger)1, @"correct number of segments");
+    XCTAssertEqual([[result intersectionSegments] count], (NSUInteger)1, @"correct number of segments");
+
+    DKUIBezierPathClippedSegment* outside = [[result differenceSegments] firstObject];
+    XCTAssertEqualWithAccuracy([outside startVector].x, 1, 0.0001, @"start tangent matches");
+    XCTAssertEqualWithAccuracy([outside startVector].y, 0, 0.0001, @"start tangent matches");
+    DKUIBezierPathClippedSegment* inside = [[result intersectionSegments] firstObject];
+    XCTAssertEqualWithAccuracy([inside endVector].x, sqrt(0.5), 0.0001, @"end tangent matches");
+    XCTAssertEqualWithAccuracy([inside endVector].y, -sqrt(0.5), 0.0001, @"end tangent matches");
+    XCTAssertEqualWithAccuracy([outside endVector].x, [inside startVector].x, 0.0001, @"same tangent where they meet");
+    XCTAssertEqualWithAccuracy([outside endVector].y, [inside startVector].y, 0.0001, @"same tangent where they meet");
+}
+
 -(void) testIntersectionOfHorizontalPathWithReversedShape{
     
     UIBezierPath* scissorPath = [UIBezierPath bezierPath];
@@ -1561,6 +1561,138 @@
     XCTAssertEqual([blueSegments count], (NSUInteger)4, @"correct number of segments");
 }
 
+-(void) testDerivedIntersectionsMatchFoundIntersections{
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(200, 200, 200, 200)];
+    UIBezierPath* scissorPath = [UIBezierPath bezierPathWithOvalInRect:CGRectMake(150, 250, 200, 200)];
+    
+    NSArray* derivedSegs = [UIBezierPath redAndGreenAndBlueSegmentsCreatedFrom:shapePath bySlicingWithPath:scissorPath andNumberOfBlueShellSegments:nil];
+    
+    [UIBezierPath setValidatesDerivedIntersections:YES];
+    __block NSArray* validatedSegs = nil;
+    XCTAssertNoThrow(validatedSegs = [UIBezierPath redAndGreenAndBlueSegmentsCreatedFrom:shapePath bySlicingWithPath:scissorPath andNumberOfBlueShellSegments:nil], @"derived intersections match");
+    [UIBezierPath setValidatesDerivedIntersections:NO];
+    
+    XCTAssertEqual([[derivedSegs firstObject] count], [[validatedSegs firstObject] count], @"correct number of segments");
+    XCTAssertEqual([[derivedSegs objectAtIndex:1] count], [[validatedSegs objectAtIndex:1] count], @"correct number of segments");
+    XCTAssertEqual([[derivedSegs lastObject] count], [[validatedSegs lastObject] count], @"correct number of segments");
+}
+
+-(void) testDerivedIntersectionsMatchFoundIntersectionsForOpenScissors{
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(200, 200, 200, 200)];
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(100, 250)];
+    [scissorPath addCurveToPoint:CGPointMake(500, 350) controlPoint1:CGPointMake(250, 150) controlPoint2:CGPointMake(350, 450)];
+    
+    NSArray* derivedSegs = [UIBezierPath redAndGreenAndBlueSegmentsCreatedFrom:shapePath bySlicingWithPath:scissorPath andNumberOfBlueShellSegments:nil];
+    
+    [UIBezierPath setValidatesDerivedIntersections:YES];
+    __block NSArray* validatedSegs = nil;
+    XCTAssertNoThrow(validatedSegs = [UIBezierPath redAndGreenAndBlueSegmentsCreatedFrom:shapePath bySlicingWithPath:scissorPath andNumberOfBlueShellSegments:nil], @"derived intersections match");
+    [UIBezierPath setValidatesDerivedIntersections:NO];
+    
+    XCTAssertEqual([[derivedSegs firstObject] count], [[validatedSegs firstObject] count], @"correct number of segments");
+    XCTAssertEqual([[derivedSegs objectAtIndex:1] count], [[validatedSegs objectAtIndex:1] count], @"correct number of segments");
+    XCTAssertEqual([[derivedSegs lastObject] count], [[validatedSegs lastObject] count], @"correct number of segments");
+    XCTAssertTrue([[derivedSegs firstObject] count] > 0, @"the scissor crosses the shape");
+}
+
+-(void) testRepeatedScissorSubpathsKeepTheirOwnIntersections{
+    // both subpaths cross the shape at the same local element
+    // and t values, so the intersections found for each subpath
+    // are equal, and only their identity tells them apart
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(50, 0, 100, 150)];
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(0, 50)];
+    [scissorPath addLineToPoint:CGPointMake(200, 50)];
+    [scissorPath moveToPoint:CGPointMake(0, 50)];
+    [scissorPath addLineToPoint:CGPointMake(200, 50)];
+    
+    DKUIBezierPathClippingResult* result = [scissorPath clipToClosedPath:shapePath withOptions:nil];
+    NSArray* intersectionSegments = [result intersectionSegments];
+    
+    XCTAssertEqual([intersectionSegments count], (NSUInteger)2, @"correct number of segments");
+    DKUIBezierPathClippedSegment* firstSegment = [intersectionSegments firstObject];
+    DKUIBezierPathClippedSegment* secondSegment = [intersectionSegments lastObject];
+    XCTAssertEqual(firstSegment.startIntersection.elementIndex1, (NSInteger)1, @"starts in the first subpath");
+    XCTAssertEqual(firstSegment.endIntersection.elementIndex1, (NSInteger)1, @"ends in the first subpath");
+    XCTAssertEqual(secondSegment.startIntersection.elementIndex1, (NSInteger)3, @"starts in the second subpath");
+    XCTAssertEqual(secondSegment.endIntersection.elementIndex1, (NSInteger)3, @"ends in the second subpath");
+}
+
+-(void) testClippingLineThroughQuadCurve{
+    
+    // the quad curve is 200t(1-t) tall and x = 100t, so the line
+    // at y = 25 crosses it at t = (1 +/- sqrt(0.5)) / 2. a cubic with
+    // both control points at the quad's control point is taller,
+    // and would be crossed near x = 26 and x = 74 instead
+    UIBezierPath* shapePath = [UIBezierPath bezierPath];
+    [shapePath moveToPoint:CGPointMake(0, 0)];
+    [shapePath addQuadCurveToPoint:CGPointMake(100, 0) controlPoint:CGPointMake(50, 100)];
+    [shapePath closePath];
+    
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(-10, 25)];
+    [scissorPath addLineToPoint:CGPointMake(110, 25)];
+    
+    DKUIBezierPathClippingResult* result = [scissorPath clipToClosedPath:shapePath withOptions:nil];
+    NSArray* intersectionSegments = [result intersectionSegments];
+    
+    XCTAssertEqual([intersectionSegments count], (NSUInteger)1, @"correct number of segments");
+    DKUIBezierPathClippedSegment* segment = [intersectionSegments firstObject];
+    CGFloat offset = 50 * sqrt(0.5);
+    XCTAssertTrue([self point:segment.startIntersection.location1 isNearTo:CGPointMake(50 - offset, 25)], @"enters where the quad is drawn");
+    XCTAssertTrue([self point:segment.endIntersection.location1 isNearTo:CGPointMake(50 + offset, 25)], @"exits where the quad is drawn");
+    XCTAssertEqualWithAccuracy(segment.startIntersection.tValue2, (1 - sqrt(0.5)) / 2, 0.001, @"same t value as the quad");
+    XCTAssertEqualWithAccuracy(segment.endIntersection.tValue2, (1 + sqrt(0.5)) / 2, 0.001, @"same t value as the quad");
+}
+
+-(void) testEqualSegmentsAndIntersectionsHashTheSame{
+    
+    // t values closer than the rounding that isEqualToIntersection:
+    // uses are the same intersection, and need the same hash
+    DKUIBezierPathIntersectionPoint* inter1 = [DKUIBezierPathIntersectionPoint intersectionAtElementIndex:1 andTValue:0.25 withElementIndex:2 andTValue:0.5 andElementCount1:3 andElementCount2:5 andLengthUntilPath1Loc:10 andLengthUntilPath2Loc:20];
+    DKUIBezierPathIntersectionPoint* inter2 = [DKUIBezierPathIntersectionPoint intersectionAtElementIndex:1 andTValue:0.25 + 0.0000001 withElementIndex:2 andTValue:0.5 - 0.0000001 andElementCount1:4 andElementCount2:6 andLengthUntilPath1Loc:10 andLengthUntilPath2Loc:20];
+    XCTAssertTrue([inter1 isEqual:inter2], @"the intersections are equal");
+    XCTAssertEqual([inter1 hash], [inter2 hash], @"equal intersections hash the same");
+    
+    // a segment is equal to its reverse
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(50, 0, 100, 150)];
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(0, 50)];
+    [scissorPath addLineToPoint:CGPointMake(200, 50)];
+    
+    DKUIBezierPathClippedSegment* segment = [[[scissorPath clipToClosedPath:shapePath withOptions:nil] intersectionSegments] firstObject];
+    DKUIBezierPathClippedSegment* reversed = [segment reversedSegment];
+    XCTAssertTrue([segment isEqual:reversed], @"the segments are equal");
+    XCTAssertEqual([segment hash], [reversed hash], @"equal segments hash the same");
+    XCTAssertEqual([[NSSet setWithObjects:segment, reversed, nil] count], (NSUInteger)1, @"a set holds the segment once");
+}
+
+-(void) testSegmentBoundsMatchTheirPaths{
+
+    // the circle crosses both sides of the square, and is
+    // closed, so its segment that's outside of the square wraps
+    // around through the start of the circle
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(250, 150, 100, 100)];
+    UIBezierPath* scissorPath = [UIBezierPath bezierPathWithOvalInRect:CGRectMake(200, 200, 200, 200)];
+
+    DKUIBezierPathClippingResult* result = [scissorPath clipToClosedPath:shapePath withOptions:nil];
+    NSArray* segments = [[result intersectionSegments] arrayByAddingObjectsFromArray:[result differenceSegments]];
+    XCTAssertEqual([segments count], (NSUInteger)2, @"correct number of segments");
+
+    for(DKUIBezierPathClippedSegment* segment in segments){
+        // the bounds are found without building the path
+        CGRect bounds = [segment bounds];
+        CGRect pathBounds = CGPathGetPathBoundingBox(segment.pathSegment.CGPath);
+        XCTAssertEqualWithAccuracy(CGRectGetMinX(bounds), CGRectGetMinX(pathBounds), 0.001, @"same bounds");
+        XCTAssertEqualWithAccuracy(CGRectGetMinY(bounds), CGRectGetMinY(pathBounds), 0.001, @"same bounds");
+        XCTAssertEqualWithAccuracy(CGRectGetMaxX(bounds), CGRectGetMaxX(pathBounds), 0.001, @"same bounds");
+        XCTAssertEqualWithAccuracy(CGRectGetMaxY(bounds), CGRectGetMaxY(pathBounds), 0.001, @"same bounds");
+        XCTAssertTrue([self point:segment.pathSegment.firstPoint isNearTo:segment.startIntersection.location1], @"starts at its intersection");
+        XCTAssertTrue([self point:segment.pathSegment.lastPoint isNearTo:segment.endIntersection.location1], @"ends at its intersection");
+    }
+}
+
 -(void) testSquareAroundCircleFindsRedGreenAndBlueSegments{
     UIBezierPath* shapePath = [UIBezierPath bezierPathWithOvalInRect:CGRectMake(200, 200, 200, 200)];
     UIBezierPath* scissorPath = [UIBezierPath bezierPathWithRect:CGRectMake(200, 200, 200, 200)];
@@ -1653,6 +1785,29 @@
     XCTAssertEqual([blueSegments count], (NSUInteger)1, @"correct number of segments");
 }
 
+-(void) testClipToRectMatchesClipToRectPath{
+    CGRect rect = CGRectMake(200, 200, 200, 100);
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(150, 250)];
+    [scissorPath addCurveToPoint:CGPointMake(450, 250) controlPoint1:CGPointMake(250, 50) controlPoint2:CGPointMake(350, 450)];
+    [scissorPath addLineToPoint:CGPointMake(300, 350)];
+    
+    DKUIBezierPathClippingResult* rectResult = [scissorPath clipToRect:rect];
+    DKUIBezierPathClippingResult* pathResult = [scissorPath clipToClosedPath:[UIBezierPath bezierPathWithRect:rect] withOptions:[DKUIBezierPathClippingOptions defaultOptions]];
+    
+    XCTAssertEqual([[rectResult intersectionSegments] count], [[pathResult intersectionSegments] count], @"correct number of segments");
+    XCTAssertEqual([[rectResult differenceSegments] count], [[pathResult differenceSegments] count], @"correct number of segments");
+    XCTAssertEqual([rectResult numberOfShellIntersectionSegments], [pathResult numberOfShellIntersectionSegments], @"correct number of segments");
+    XCTAssertEqual([rectResult numberOfShellDifferenceSegments], [pathResult numberOfShellDifferenceSegments], @"correct number of segments");
+    
+    for(int i=0;i<[[rectResult intersectionSegments] count];i++){
+        UIBezierPath* rectSegment = [[[rectResult intersectionSegments] objectAtIndex:i] pathSegment];
+        UIBezierPath* pathSegment = [[[pathResult intersectionSegments] objectAtIndex:i] pathSegment];
+        XCTAssertTrue([self point:rectSegment.firstPoint isNearTo:pathSegment.firstPoint], @"same segment");
+        XCTAssertTrue([self point:rectSegment.lastPoint isNearTo:pathSegment.lastPoint], @"same segment");
+    }
+}
+
 -(void) testClipPathMethodForUnclosedPaths{
     UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(200, 200, 200, 100)];
     UIBezierPath* scissorPath = [UIBezierPath bezierPath];
@@ -2453,4 +2453,184 @@
 
 
 
+-(void) testAsynchronousSlicingFindsSameShapes{
+    
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(0, 50)];
+    [scissorPath addLineToPoint:CGPointMake(200, 50)];
+    
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(50, 0, 100, 150)];
+    
+    XCTestExpectation* finished = [self expectationWithDescription:@"slicing finished"];
+    [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withOptions:nil completion:^(NSArray* shapes){
+        XCTAssertTrue([NSThread isMainThread], @"completion is on the main thread");
+        XCTAssertEqual([shapes count], (NSUInteger)2, @"found shapes");
+        [finished fulfill];
+    }];
+    // changing the path after the call can't change the result
+    [scissorPath removeAllPoints];
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+}
+
+-(void) testCancelledSlicingNeverCompletes{
+    
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(0, 50)];
+    [scissorPath addLineToPoint:CGPointMake(200, 50)];
+    
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(50, 0, 100, 150)];
+    
+    __block BOOL completed = NO;
+    DKUIBezierPathClippingOperation* operation = [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withOptions:nil completion:^(NSArray* shapes){
+        completed = YES;
+    }];
+    [operation cancel];
+    XCTAssertTrue(operation.isCancelled, @"operation is cancelled");
+    
+    // give the background work plenty of time to have finished
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.5]];
+    XCTAssertFalse(completed, @"cancelled operations never complete");
+}
+
+-(void) testSlicingCancelledFromAnotherQueueNeverCompletes{
+    
+    // a wavy shape and scissor that cross hundreds of times,
+    // so the slicing takes long enough to be cancelled part way
+    UIBezierPath* shapePath = [UIBezierPath bezierPath];
+    [shapePath moveToPoint:CGPointMake(0, 0)];
+    for(int i = 0; i < 200; i++){
+        [shapePath addCurveToPoint:CGPointMake(i * 10 + 10, 0) controlPoint1:CGPointMake(i * 10 + 3, 40) controlPoint2:CGPointMake(i * 10 + 7, -40)];
+    }
+    [shapePath addLineToPoint:CGPointMake(2000, 200)];
+    [shapePath addLineToPoint:CGPointMake(0, 200)];
+    [shapePath closePath];
+    
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(-10, -10)];
+    for(int i = 0; i < 200; i++){
+        [scissorPath addCurveToPoint:CGPointMake(i * 10 + 5, (i % 2) ? -10 : 210) controlPoint1:CGPointMake(i * 10 - 2, 100) controlPoint2:CGPointMake(i * 10 + 2, 100)];
+    }
+    
+    // time the same work done synchronously, and cancel
+    // a quarter of the way through the background run
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withOptions:nil];
+    CFAbsoluteTime duration = CFAbsoluteTimeGetCurrent() - start;
+    
+    __block BOOL completed = NO;
+    DKUIBezierPathClippingOperation* operation = [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withOptions:nil completion:^(NSArray* shapes){
+        completed = YES;
+    }];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(duration / 4 * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        [operation cancel];
+    });
+    
+    // wait well past when the work would have finished
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:duration * 2 + 0.5]];
+    XCTAssertTrue(operation.isCancelled, @"operation is cancelled");
+    XCTAssertFalse(completed, @"operations cancelled part way through never complete");
+}
+
+-(void) testDeadlineTiers{
+    
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(0, 50)];
+    [scissorPath addCurveToPoint:CGPointMake(200, 50) controlPoint1:CGPointMake(60, 20) controlPoint2:CGPointMake(140, 80)];
+    
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithOvalInRect:CGRectMake(50, 0, 100, 150)];
+    
+    DKUIBezierPathClippingTier tier = DKUIBezierPathClippingTierFull;
+    NSArray* coarseShapes = [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withOptions:nil deadline:CFAbsoluteTimeGetCurrent() tier:&tier];
+    XCTAssertEqual(tier, DKUIBezierPathClippingTierCoarse, @"no time for the full result");
+    XCTAssertEqual([coarseShapes count], (NSUInteger)2, @"found coarse shapes");
+    
+    NSArray* fullShapes = [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withOptions:nil deadline:CFAbsoluteTimeGetCurrent() + 60 tier:&tier];
+    XCTAssertEqual(tier, DKUIBezierPathClippingTierFull, @"plenty of time for the full result");
+    XCTAssertEqual([fullShapes count], (NSUInteger)2, @"found full shapes");
+    
+    // the coarse lines stay within half a point of the curves
+    CGFloat coarseArea = 0;
+    CGFloat fullArea = 0;
+    for(NSUInteger i = 0; i < 2; i++){
+        coarseArea += ABS([[coarseShapes objectAtIndex:i] signedArea]);
+        fullArea += ABS([[fullShapes objectAtIndex:i] signedArea]);
+    }
+    XCTAssertEqualWithAccuracy(coarseArea, fullArea, fullArea * 0.02, @"coarse shapes are close to the full shapes");
+}
+
+-(void) testShapeAreaAndCentroid{
+    
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(0, 50)];
+    [scissorPath addLineToPoint:CGPointMake(200, 50)];
+    
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(50, 0, 100, 150)];
+    
+    NSArray* shapes = [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath];
+    XCTAssertEqual([shapes count], (NSUInteger)2, @"found shapes");
+    
+    DKUIBezierPathShape* topShape = [shapes firstObject];
+    DKUIBezierPathShape* bottomShape = [shapes lastObject];
+    if([topShape centroid].y > [bottomShape centroid].y){
+        topShape = [shapes lastObject];
+        bottomShape = [shapes firstObject];
+    }
+    XCTAssertEqualWithAccuracy(ABS([topShape signedArea]), 5000, 0.01, @"area of the top");
+    XCTAssertEqualWithAccuracy(ABS([bottomShape signedArea]), 10000, 0.01, @"area of the bottom");
+    XCTAssertTrue([self point:[topShape centroid] isNearTo:CGPointMake(100, 25)], @"centroid of the top");
+    XCTAssertTrue([self point:[bottomShape centroid] isNearTo:CGPointMake(100, 100)], @"centroid of the bottom");
+    
+    // half of an ellipse has its centroid 4b/3π from its flat side
+    shapePath = [UIBezierPath bezierPathWithOvalInRect:CGRectMake(50, 0, 100, 150)];
+    [scissorPath removeAllPoints];
+    [scissorPath moveToPoint:CGPointMake(0, 75)];
+    [scissorPath addLineToPoint:CGPointMake(200, 75)];
+    
+    shapes = [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath];
+    XCTAssertEqual([shapes count], (NSUInteger)2, @"found shapes");
+    for(DKUIBezierPathShape* shape in shapes){
+        CGPoint centroid = [shape centroid];
+        CGFloat expectedY = centroid.y < 75 ? 75 - 4 * 75 / (3 * M_PI) : 75 + 4 * 75 / (3 * M_PI);
+        XCTAssertEqualWithAccuracy(ABS([shape signedArea]), M_PI * 50 * 75 / 2, 5, @"area of half the oval");
+        XCTAssertEqualWithAccuracy(centroid.x, 100, 0.01, @"centroid is centered");
+        XCTAssertEqualWithAccuracy(centroid.y, expectedY, 0.1, @"centroid of half the oval");
+    }
+}
+
+-(void) testMinimumAreaDropsSlivers{
+    
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    [scissorPath moveToPoint:CGPointMake(0, 0.5)];
+    [scissorPath addLineToPoint:CGPointMake(200, 0.5)];
+    
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(50, 0, 100, 150)];
+    
+    NSArray* shapes = [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withOptions:nil];
+    XCTAssertEqual([shapes count], (NSUInteger)2, @"found the sliver");
+    
+    DKUIBezierPathClippingOptions* options = [DKUIBezierPathClippingOptions defaultOptions];
+    options.minimumArea = 100;
+    shapes = [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath withOptions:options];
+    XCTAssertEqual([shapes count], (NSUInteger)1, @"dropped the sliver");
+    XCTAssertEqualWithAccuracy(ABS([[shapes firstObject] signedArea]), 14950, 0.01, @"kept the large shape");
+}
+
+-(void) testShapeAreaAndCentroidSubtractHoles{
+    
+    UIBezierPath* scissorPath = [UIBezierPath bezierPath];
+    
+    UIBezierPath* shapePath = [UIBezierPath bezierPathWithRect:CGRectMake(200, 200, 200, 200)];
+    [shapePath appendPath:[[UIBezierPath bezierPathWithRect:CGRectMake(210, 210, 100, 100)] bezierPathByReversingPath]];
+    
+    NSArray* shapes = [shapePath uniqueShapesCreatedFromSlicingWithUnclosedPath:scissorPath];
+    XCTAssertEqual([shapes count], (NSUInteger)1, @"found shapes");
+    DKUIBezierPathShape* shape = [shapes firstObject];
+    XCTAssertEqual([shape.holes count], (NSUInteger)1, @"found the hole");
+    
+    // the hole is off center, so it pulls the centroid away from itself
+    CGFloat expected = (40000 * 300 - 10000 * 260) / 30000.0;
+    XCTAssertEqualWithAccuracy(ABS([shape signedArea]), 30000, 0.01, @"the hole is subtracted from the area");
+    XCTAssertTrue([self point:[shape centroid] isNearTo:CGPointMake(expected, expected)], @"the hole is subtracted from the centroid");
+}
+
 @end